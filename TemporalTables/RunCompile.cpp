@@ -1,6 +1,8 @@
 #include <iomanip>
 #include <iostream>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/algorithm/string/classification.hpp>
 #include "utils/DatabaseTools.h"
 
 string testQueries[] = {
@@ -14,6 +16,53 @@ string testQueries[] = {
         "SELECT * FROM warehouse FOR SYSTEM_TIME AS OF '2017-02-08 11:22:42' WHERE w_id=1",//7
 };
 
+/// A statement of the console, compiled by the compiler service until it runs
+struct Statement {
+    string line;
+    /// The console has no prepared statements, the parameters are the constants of the query
+    vector<string> parameters;
+    string file;
+    shared_future<long> build;
+};
+
+/// Write the code of a statement and start compiling it
+static Statement prepare(const string& line, Schema* schema) {
+    Statement statement;
+    statement.line = line;
+    statement.file = DatabaseTools::parseAndWriteQuery(line, schema, statement.parameters);
+    statement.build = DatabaseTools::compileTiered(statement.file);
+    return statement;
+}
+
+/// Wait for the build of a statement and run it
+static void execute(Statement& statement, Schema* schema, Database* db) {
+    const long timeCompile = statement.build.get();
+    long timeExecute = 0;
+    PlanRegistry::Tier tier = PlanRegistry::Tier::Optimized;
+    if (timeCompile >= 0) {
+        timeExecute = DatabaseTools::loadAndRunQuery(statement.file, db, statement.parameters, &tier);
+        //Inserts and deletes change the row counts the planner estimates with
+        DatabaseTools::loadStatistics(schema, db);
+    } else {
+        cerr << "\tCompilation failed..." << endl;
+    }
+    cout << "\033[34mCompile: " << timeCompile << "ms / Execute: " << timeExecute << "us / ";
+    if (tier == PlanRegistry::Tier::Fast) {
+        cout << "Fast build, optimizing in the background";
+    } else if (tier == PlanRegistry::Tier::Profiling) {
+        cout << "Profiling build";
+    } else if (tier == PlanRegistry::Tier::Profiled) {
+        cout << "Profile-guided build";
+    } else {
+        const long timeOptimize = DatabaseTools::plans.optimizeTime(DatabaseTools::library(statement.file));
+        cout << "Optimized build";
+        if (timeOptimize >= 0) {
+            cout << " (compiled in " << timeOptimize << "ms)";
+        }
+    }
+    cout << " \033[0m" << endl;
+}
+
 int main(int argc, char** argv) {
     if (argc != 2) {
         argv[1] = (char*) "./script/schema_performance.sql";
@@ -43,13 +92,12 @@ int main(int argc, char** argv) {
         cout << "aborting due to schema failed to load" << endl;
         return 1;
     }
+    DatabaseTools::loadStatistics(schema, db);
 
     //Output some Info & Enable input
-    cout << "Enter a sql query, 'show queries', 'run <query>', 'show performance', 'show schema' or 'exit' to quit: " << endl;
+    cout << "Enter a sql query, 'show queries', 'run <query>', 'analyze [table]', 'show plans', 'set plans <limit>', 'set engine <auto|compile|interpret>', "
+            "'set profile <executions>', 'interpret <query>', 'compile <query>', 'source <file>', 'show performance', 'show schema' or 'exit' to quit: " << endl;
     string line;
-    long timeCompile = 0, timeExecute = 0;
-    //Pass an empty vector as we don't support prepared statements on the console
-    vector<string> parameters;
     do {
         //Do we want to exit?
         if (line == "exit") {
@@ -75,20 +123,86 @@ int main(int argc, char** argv) {
             }
         } else if (line == "show schema") { //Display the database schema
             cout << schema->toString() << endl;
+        } else if (boost::istarts_with(line, "analyze")) { //Compute the statistics of the planner: ANALYZE [table]
+            string relation = boost::trim_copy_if(line.substr(7), boost::is_any_of(" ;"));
+            try {
+                DatabaseTools::analyze(schema, db, relation);
+            } catch (ParserError& e) {
+                cerr << e.what() << endl;
+            }
+        } else if (line == "show plans") { //Compiled queries that are kept loaded
+            cout << DatabaseTools::plans.toString() << endl;
+        } else if (boost::starts_with(line, "set plans")) { //Number of compiled queries to keep loaded
+            try {
+                DatabaseTools::plans.setLimit(stoul(line.substr(9)));
+                cout << DatabaseTools::plans.toString() << endl;
+            } catch (logic_error&) {
+                cout << "Expected the number of queries to keep loaded" << endl;
+            }
+        } else if (boost::starts_with(line, "set engine")) { //Compile or interpret queries, auto interprets them once
+            const string engine = boost::trim_copy(line.substr(10));
+            if (engine == "auto") {
+                DatabaseTools::engine = DatabaseTools::Engine::Auto;
+            } else if (engine == "compile") {
+                DatabaseTools::engine = DatabaseTools::Engine::Compile;
+            } else if (engine == "interpret") {
+                DatabaseTools::engine = DatabaseTools::Engine::Interpret;
+            } else {
+                cout << "Expected auto, compile or interpret" << endl;
+            }
+        } else if (boost::starts_with(line, "set profile")) { //Executions after which a query is compiled with a profile
+            try {
+                DatabaseTools::profileRuns = stoull(line.substr(11));
+            } catch (logic_error&) {
+                cout << "Expected the number of executions, 0 to never profile" << endl;
+            }
+        } else if (boost::starts_with(line, "source ")) { //Run a script, all its statements are compiled ahead
+            ifstream script(boost::trim_copy(line.substr(7)));
+            if (!script.is_open()) {
+                cout << "Script not found!" << endl;
+            }
+            vector<Statement> statements;
+            string statement;
+            while (getline(script, statement)) {
+                boost::trim_if(statement, boost::is_any_of(" \t;"));
+                if (statement.empty()) {
+                    continue;
+                }
+                try {
+                    statements.push_back(prepare(statement, schema));
+                } catch (ParserError& e) {
+                    cerr << e.what() << " on line " << e.where() << ": " << statement << endl;
+                } catch (SQLParser::ParserException& e) {
+                    cerr << e.what() << ": " << statement << endl;
+                }
+            }
+            for (auto& prepared : statements) {
+                cout << ">" << prepared.line << endl;
+                execute(prepared, schema, db);
+            }
         } else if (line == "show performance") { //Performance test the database
             DatabaseTools::performanceTest(schema, db);
         } else if (line == "show performance2") { //Performance test the database
             DatabaseTools::performanceTest2(schema, db);
         } else if (line != "") { //Actually proccess queries
             try {
-                string file = DatabaseTools::parseAndWriteQuery(line, schema);
-                timeCompile = DatabaseTools::compileFile(file);
-                if (timeCompile >= 0) {
-                    timeExecute = DatabaseTools::loadAndRunQuery(file, db, parameters);
+                //A query can choose the engine with a prefix
+                auto engine = DatabaseTools::engine;
+                if (boost::starts_with(line, "interpret ")) {
+                    engine = DatabaseTools::Engine::Interpret;
+                    line = line.substr(10);
+                } else if (boost::starts_with(line, "compile ")) {
+                    engine = DatabaseTools::Engine::Compile;
+                    line = line.substr(8);
+                }
+                const long timeExecute = DatabaseTools::interpretQuery(line, schema, db, engine);
+                if (timeExecute >= 0) {
+                    DatabaseTools::loadStatistics(schema, db);
+                    cout << "\033[34mInterpreted / Execute: " << timeExecute << "us \033[0m" << endl;
                 } else {
-                    cerr << "\tCompilation failed..." << endl;
+                    Statement statement = prepare(line, schema);
+                    execute(statement, schema, db);
                 }
-                cout << "\033[34mCompile: " << timeCompile << "ms / Execute: " << timeExecute << "us \033[0m" << endl;
             } catch (ParserError& e) {
                 cerr << e.what() << " on line " << e.where() << endl;
             } catch (SQLParser::ParserException& e) {
@@ -98,6 +212,7 @@ int main(int argc, char** argv) {
 
         cout << ">";
     } while (getline(cin, line));
+    DatabaseTools::waitForBuilds();
 
     //Turn off warnings caused by generated Database code, that is not available at compile time
 #pragma GCC diagnostic push
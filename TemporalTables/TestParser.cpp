@@ -56,6 +56,28 @@ int main(int argc, char** argv) {
         cerr << e.what() << " on line " << e.where() << endl;
     }
 
+    //Queries the parser has to reject instead of reading them differently
+    const char* rejected[] = {
+            "select w_id from warehouse, district where w_id = 7 and (w_id = d_w_id or w_id = 1)",
+            "select w_id from warehouse, district where w_id = d_w_id or w_id = 1",
+            "select w_id from warehouse where w_id = 7 and (w_id = 1 or w_tax = 2)",
+    };
+    int failed = 0;
+    for (const char* query : rejected) {
+        SQLLexer lexer(query);
+        SQLParser parser(lexer);
+        try {
+            delete parser.parse(schema);
+            cerr << "Accepted: " << query << endl;
+            failed++;
+        } catch (SQLParser::ParserException& e) {
+            cout << "Rejected: " << query << " (" << e.what() << ")" << endl;
+        }
+    }
+
     delete schema;
+    if (failed > 0) {
+        return 1;
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,713 @@
+#include <dlfcn.h>
+#include <array>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <utility>
+#include "Interpreter.h"
+#include "Kernels.h"
+#include "../operators/TableScan.h"
+#include "../operators/IndexScan.h"
+#include "../operators/Selection.h"
+#include "../operators/HashJoin.h"
+#include "../operators/IndexJoin.h"
+#include "../operators/Print.h"
+#include "../operators/Update.h"
+#include "../operators/Delete.h"
+
+using namespace std;
+
+using Batch = Interpreter::Batch;
+using Column = Interpreter::Column;
+using Storage = Interpreter::Storage;
+
+template<unsigned precision>
+static int64_t castNumeric(const string& value) {
+    return Numeric<18, precision>::castString(value.c_str(), (uint32_t) value.size()).getRaw();
+}
+
+template<unsigned precision>
+static void printNumeric(ostream& out, const char* value) {
+    out << *reinterpret_cast<const Numeric<18, precision>*>(value);
+}
+
+/// The cast and the output of a Numeric only depend on its precision, one instantiation per precision
+template<unsigned... precision>
+static array<int64_t (*)(const string&), sizeof...(precision)> numericCasts(integer_sequence<unsigned, precision...>) {
+    return {{&castNumeric<precision>...}};
+}
+
+template<unsigned... precision>
+static array<void (*)(ostream&, const char*), sizeof...(precision)> numericPrinters(integer_sequence<unsigned, precision...>) {
+    return {{&printNumeric<precision>...}};
+}
+
+static const auto castNumerics = numericCasts(make_integer_sequence<unsigned, 19>());
+static const auto printNumerics = numericPrinters(make_integer_sequence<unsigned, 19>());
+
+/// Bytes of the length of a string
+static size_t lengthSize(Storage storage) {
+    return storage == Storage::String8 ? 1 : storage == Storage::String16 ? 2 : 4;
+}
+
+static size_t stringLength(Storage storage, const char* value) {
+    switch (storage) {
+        case Storage::String8:
+            return *reinterpret_cast<const uint8_t*>(value);
+        case Storage::String16:
+            return *reinterpret_cast<const uint16_t*>(value);
+        default:
+            return *reinterpret_cast<const uint32_t*>(value);
+    }
+}
+
+/// Output a value the way the generated code does, with the output operator of its type
+static void print(ostream& out, const Column& column, uint32_t row) {
+    const char* value = column.values + row * column.stride;
+    switch (column.attr->type) {
+        case Types::Tag::Integer:
+            out << *reinterpret_cast<const Integer*>(value);
+            break;
+        case Types::Tag::Numeric:
+            printNumerics[column.attr->len2](out, value);
+            break;
+        case Types::Tag::Date:
+            out << *reinterpret_cast<const Date*>(value);
+            break;
+        case Types::Tag::Timestamp:
+        case Types::Tag::Datetime:
+            out << *reinterpret_cast<const Timestamp*>(value);
+            break;
+        case Types::Tag::Char:
+        case Types::Tag::Varchar:
+            if (column.storage == Storage::Char) {
+                out << *reinterpret_cast<const Char<1>*>(value);
+            } else {
+                out << string(value + lengthSize(column.storage), stringLength(column.storage, value));
+            }
+            break;
+    }
+}
+
+/// Hash the values of the key columns of the first n tuples
+static void hashKeys(const vector<Column>& keys, const Batch& batch, unsigned n, vector<uint64_t>& hashes) {
+    hashes.assign(n, 0);
+    for (auto& key : keys) {
+        const uint32_t* rows = batch.rows[key.slot].data();
+        switch (key.storage) {
+            case Storage::Int64:
+                Kernels::hash<int64_t>(key.values, key.stride, rows, n, hashes.data());
+                break;
+            case Storage::Int32:
+                Kernels::hash<int32_t>(key.values, key.stride, rows, n, hashes.data());
+                break;
+            case Storage::UInt64:
+                Kernels::hash<uint64_t>(key.values, key.stride, rows, n, hashes.data());
+                break;
+            case Storage::Char:
+                Kernels::hash<char>(key.values, key.stride, rows, n, hashes.data());
+                break;
+            case Storage::String8:
+                Kernels::hashString<uint8_t>(key.values, key.stride, rows, n, hashes.data());
+                break;
+            case Storage::String16:
+                Kernels::hashString<uint16_t>(key.values, key.stride, rows, n, hashes.data());
+                break;
+            case Storage::String32:
+                Kernels::hashString<uint32_t>(key.values, key.stride, rows, n, hashes.data());
+                break;
+        }
+    }
+}
+
+static bool (* keyEqual(Storage storage))(const char*, const char*) {
+    switch (storage) {
+        case Storage::Int64:
+            return &Kernels::equal<int64_t>;
+        case Storage::Int32:
+            return &Kernels::equal<int32_t>;
+        case Storage::UInt64:
+            return &Kernels::equal<uint64_t>;
+        case Storage::Char:
+            return &Kernels::equal<char>;
+        case Storage::String8:
+            return &Kernels::equalString<uint8_t>;
+        case Storage::String16:
+            return &Kernels::equalString<uint16_t>;
+        default:
+            return &Kernels::equalString<uint32_t>;
+    }
+}
+
+/// The rows of a table in batches
+class Scan : public Interpreter::Node {
+    unsigned slot;
+    size_t count;
+    size_t position = 0;
+
+public:
+    Scan(unsigned slot, size_t count) : slot(slot), count(count) {
+        slots.push_back(slot);
+    }
+
+    bool next(Batch& batch) override {
+        if (position >= count) {
+            return false;
+        }
+        batch.size = (unsigned) min<size_t>(Interpreter::batchSize, count - position);
+        auto& rows = batch.rows[slot];
+        rows.resize(batch.size);
+        iota(rows.begin(), rows.end(), (uint32_t) position);
+        position += batch.size;
+        return true;
+    }
+};
+
+/// The tuples of the input for which all conditions hold, each condition only checks the tuples left by the previous
+class Filter : public Interpreter::Node {
+    unique_ptr<Node> input;
+    vector<Interpreter::Condition> conditions;
+    vector<uint32_t> sel;
+
+public:
+    Filter(unique_ptr<Node> input, vector<Interpreter::Condition> conditions)
+            : input(move(input)), conditions(move(conditions)) {
+        slots = this->input->slots;
+    }
+
+    bool next(Batch& batch) override {
+        while (input->next(batch)) {
+            sel.resize(batch.size);
+            iota(sel.begin(), sel.end(), 0);
+            unsigned n = batch.size;
+            for (auto& condition : conditions) {
+                if (n == 0) {
+                    break;
+                }
+                n = condition(batch, sel.data(), n, sel.data());
+            }
+            if (n == 0) {
+                continue;
+            }
+
+            if (n < batch.size) {
+                for (auto slot : slots) {
+                    auto& rows = batch.rows[slot];
+                    for (unsigned i = 0; i < n; i++) {
+                        rows[i] = rows[sel[i]];
+                    }
+                    rows.resize(n);
+                }
+                batch.size = n;
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+/// Hash join, the build side is read completely into a chained hash table on the first call, then every batch of the
+/// probe side is joined with it
+class Join : public Interpreter::Node {
+    unique_ptr<Node> build;
+    unique_ptr<Node> probe;
+    /// Key columns of both sides, the values of a key pair have the same type
+    vector<Column> buildKeys, probeKeys;
+    vector<bool (*)(const char*, const char*)> equal;
+
+    bool built = false;
+    /// Rows of the tuples of the build side per slot, the hash table links the tuples with the same bucket
+    vector<vector<uint32_t>> buildRows;
+    vector<uint64_t> buildHashes;
+    vector<uint32_t> buckets, chain;
+    uint64_t mask = 0;
+
+    Batch input;
+    vector<uint64_t> hashes;
+
+    static const uint32_t end = ~0u;
+
+    void finishBuild(size_t slotCount) {
+        buildRows.resize(slotCount);
+        input.rows.resize(slotCount);
+        while (build->next(input)) {
+            hashKeys(buildKeys, input, input.size, hashes);
+            buildHashes.insert(buildHashes.end(), hashes.begin(), hashes.end());
+            for (auto slot : build->slots) {
+                buildRows[slot].insert(buildRows[slot].end(), input.rows[slot].begin(), input.rows[slot].end());
+            }
+        }
+
+        size_t size = 1;
+        while (size < 2 * buildHashes.size()) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        buckets.assign(size, end);
+        chain.resize(buildHashes.size());
+        for (uint32_t i = 0; i < buildHashes.size(); i++) {
+            auto& bucket = buckets[buildHashes[i] & mask];
+            chain[i] = bucket;
+            bucket = i;
+        }
+        built = true;
+    }
+
+    bool matches(uint32_t tuple, unsigned i) const {
+        for (size_t k = 0; k < buildKeys.size(); k++) {
+            auto& b = buildKeys[k];
+            auto& p = probeKeys[k];
+            if (!equal[k](b.values + buildRows[b.slot][tuple] * b.stride, p.values + input.rows[p.slot][i] * p.stride)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    Join(unique_ptr<Node> build, unique_ptr<Node> probe, vector<Column> buildKeys, vector<Column> probeKeys)
+            : build(move(build)), probe(move(probe)), buildKeys(move(buildKeys)), probeKeys(move(probeKeys)) {
+        slots = this->build->slots;
+        slots.insert(slots.end(), this->probe->slots.begin(), this->probe->slots.end());
+        for (auto& key : this->buildKeys) {
+            equal.push_back(keyEqual(key.storage));
+        }
+    }
+
+    bool next(Batch& batch) override {
+        if (!built) {
+            finishBuild(batch.rows.size());
+        }
+        if (buildHashes.empty()) {
+            return false;
+        }
+
+        while (probe->next(input)) {
+            hashKeys(probeKeys, input, input.size, hashes);
+            for (auto slot : slots) {
+                batch.rows[slot].clear();
+            }
+            for (unsigned i = 0; i < input.size; i++) {
+                for (uint32_t tuple = buckets[hashes[i] & mask]; tuple != end; tuple = chain[tuple]) {
+                    if (buildHashes[tuple] != hashes[i] || !matches(tuple, i)) {
+                        continue;
+                    }
+                    for (auto slot : build->slots) {
+                        batch.rows[slot].push_back(buildRows[slot][tuple]);
+                    }
+                    for (auto slot : probe->slots) {
+                        batch.rows[slot].push_back(input.rows[slot][i]);
+                    }
+                }
+            }
+            batch.size = (unsigned) batch.rows[slots.front()].size();
+            if (batch.size > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+Interpreter::Interpreter(Database* db, void* library, const vector<string>& params) : db(db), params(params) {
+    tableLayout = reinterpret_cast<decltype(tableLayout)>(dlsym(library, "tableLayout"));
+    removeRows = reinterpret_cast<decltype(removeRows)>(dlsym(library, "removeRows"));
+    updateRows = reinterpret_cast<decltype(updateRows)>(dlsym(library, "updateRows"));
+    if (!tableLayout || !removeRows || !updateRows) {
+        throw "The database library has no functions for the interpreter";
+    }
+}
+
+unsigned Interpreter::slot(TableScan* scan) {
+    for (unsigned i = 0; i < scans.size(); i++) {
+        if (scans[i] == scan) {
+            return i;
+        }
+    }
+    scans.push_back(scan);
+    layouts.emplace_back();
+    tableLayout(db, scan->getRelation().name, layouts.back());
+    return (unsigned) scans.size() - 1;
+}
+
+Interpreter::Storage Interpreter::storage(const Schema::Relation::Attribute& attr) {
+    switch (attr.type) {
+        case Types::Tag::Integer:
+        case Types::Tag::Numeric:
+            return Storage::Int64;
+        case Types::Tag::Date:
+            return Storage::Int32;
+        case Types::Tag::Timestamp:
+        case Types::Tag::Datetime:
+            return Storage::UInt64;
+        case Types::Tag::Char:
+            if (attr.len1 == 1) {
+                return Storage::Char;
+            }
+        case Types::Tag::Varchar:
+            break;
+    }
+    return attr.len1 < 256 ? Storage::String8 : attr.len1 < 65536 ? Storage::String16 : Storage::String32;
+}
+
+Column Interpreter::column(IU* iu) {
+    const unsigned s = slot(iu->rel);
+    const size_t index = iu->attr - iu->rel->getRelation().attributes.data();
+    auto& layout = layouts[s];
+    return {iu->attr, storage(*iu->attr), s, layout.rows + layout.offsets[index], layout.rowSize};
+}
+
+Interpreter::Condition Interpreter::condition(const Column& column, const Predicate& predicate) {
+    if (predicate.op == CompareOp::In) {
+        vector<string> list;
+        for (size_t i = 0; i < predicate.values.size(); i++) {
+            list.push_back(predicate.values[i] == "?" ? params.at(predicate.params[i]) : predicate.values[i]);
+        }
+        return inCondition(column, list);
+    }
+
+    string value = predicate.value == "?" ? params.at(predicate.param) : predicate.value;
+    const char* values = column.values;
+    const size_t stride = column.stride;
+    const unsigned slot = column.slot;
+
+    if (predicate.op == CompareOp::Like) {
+        switch (column.storage) {
+            case Storage::Char:
+                return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                    return Kernels::selectCharLike(values, stride, b.rows[slot].data(), sel, n, value.data(), (unsigned) value.size(), out);
+                };
+            case Storage::String8:
+                return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                    return Kernels::selectStringLike<uint8_t>(values, stride, b.rows[slot].data(), sel, n, value.data(), (unsigned) value.size(), out);
+                };
+            case Storage::String16:
+                return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                    return Kernels::selectStringLike<uint16_t>(values, stride, b.rows[slot].data(), sel, n, value.data(), (unsigned) value.size(), out);
+                };
+            case Storage::String32:
+                return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                    return Kernels::selectStringLike<uint32_t>(values, stride, b.rows[slot].data(), sel, n, value.data(), (unsigned) value.size(), out);
+                };
+            default:
+                return nullptr;
+        }
+    }
+
+    //The constant is cast to the type of the column once, as the generated code does with the parameters
+    const CompareOp op = predicate.op;
+    switch (column.storage) {
+        case Storage::Int64: {
+            auto& attr = *column.attr;
+            const int64_t constant = attr.type == Types::Tag::Integer ? Integer::castString(value.c_str(), (uint32_t) value.size()).value
+                                                                      : castNumerics.at(attr.len2)(value);
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectCompare<int64_t>(values, stride, b.rows[slot].data(), sel, n, op, constant, out);
+            };
+        }
+        case Storage::Int32: {
+            const int32_t constant = Date::castString(value.c_str(), (uint32_t) value.size()).value;
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectCompare<int32_t>(values, stride, b.rows[slot].data(), sel, n, op, constant, out);
+            };
+        }
+        case Storage::UInt64: {
+            const uint64_t constant = Timestamp::castString(value.c_str(), (uint32_t) value.size()).value;
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectCompare<uint64_t>(values, stride, b.rows[slot].data(), sel, n, op, constant, out);
+            };
+        }
+        case Storage::Char: {
+            const char constant = Char<1>::castString(value.c_str(), (uint32_t) value.size()).value;
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectCompare<char>(values, stride, b.rows[slot].data(), sel, n, op, constant, out);
+            };
+        }
+        default:
+            break;
+    }
+
+    //Char drops leading spaces, a string longer than the column is equal to nothing
+    if (column.attr->type == Types::Tag::Char) {
+        value.erase(0, value.find_first_not_of(' ') == string::npos ? value.size() : value.find_first_not_of(' '));
+    }
+    if (value.size() > column.attr->len1 && op == CompareOp::Equal) {
+        return [](const Batch&, const uint32_t*, unsigned, uint32_t*) { return 0u; };
+    }
+    if (op != CompareOp::Equal) {
+        switch (column.storage) {
+            case Storage::String8:
+                return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                    return Kernels::selectStringCompare<uint8_t>(values, stride, b.rows[slot].data(), sel, n, op, value.data(), (unsigned) value.size(), out);
+                };
+            case Storage::String16:
+                return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                    return Kernels::selectStringCompare<uint16_t>(values, stride, b.rows[slot].data(), sel, n, op, value.data(), (unsigned) value.size(), out);
+                };
+            default:
+                return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                    return Kernels::selectStringCompare<uint32_t>(values, stride, b.rows[slot].data(), sel, n, op, value.data(), (unsigned) value.size(), out);
+                };
+        }
+    }
+    switch (column.storage) {
+        case Storage::String8:
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectStringEqual<uint8_t>(values, stride, b.rows[slot].data(), sel, n, value.data(), (unsigned) value.size(), out);
+            };
+        case Storage::String16:
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectStringEqual<uint16_t>(values, stride, b.rows[slot].data(), sel, n, value.data(), (unsigned) value.size(), out);
+            };
+        default:
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectStringEqual<uint32_t>(values, stride, b.rows[slot].data(), sel, n, value.data(), (unsigned) value.size(), out);
+            };
+    }
+}
+
+/// The cast values of an IN list, sorted for the kernel
+template<class T, class Cast>
+static vector<T> castList(const vector<string>& list, Cast cast) {
+    vector<T> values;
+    for (auto& value : list) {
+        values.push_back(cast(value));
+    }
+    sort(values.begin(), values.end());
+    values.erase(unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+Interpreter::Condition Interpreter::inCondition(const Column& column, const vector<string>& list) {
+    const char* values = column.values;
+    const size_t stride = column.stride;
+    const unsigned slot = column.slot;
+
+    switch (column.storage) {
+        case Storage::Int64: {
+            auto& attr = *column.attr;
+            auto constants = castList<int64_t>(list, [&](const string& value) {
+                return attr.type == Types::Tag::Integer ? Integer::castString(value.c_str(), (uint32_t) value.size()).value
+                                                        : castNumerics.at(attr.len2)(value);
+            });
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectIn<int64_t>(values, stride, b.rows[slot].data(), sel, n, constants.data(), (unsigned) constants.size(), out);
+            };
+        }
+        case Storage::Int32: {
+            auto constants = castList<int32_t>(list, [](const string& value) {
+                return Date::castString(value.c_str(), (uint32_t) value.size()).value;
+            });
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectIn<int32_t>(values, stride, b.rows[slot].data(), sel, n, constants.data(), (unsigned) constants.size(), out);
+            };
+        }
+        case Storage::UInt64: {
+            auto constants = castList<uint64_t>(list, [](const string& value) {
+                return Timestamp::castString(value.c_str(), (uint32_t) value.size()).value;
+            });
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectIn<uint64_t>(values, stride, b.rows[slot].data(), sel, n, constants.data(), (unsigned) constants.size(), out);
+            };
+        }
+        case Storage::Char: {
+            auto constants = castList<char>(list, [](const string& value) {
+                return Char<1>::castString(value.c_str(), (uint32_t) value.size()).value;
+            });
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectIn<char>(values, stride, b.rows[slot].data(), sel, n, constants.data(), (unsigned) constants.size(), out);
+            };
+        }
+        default:
+            break;
+    }
+
+    //Char drops leading spaces, a string longer than the column is equal to nothing
+    vector<string> constants;
+    for (auto value : list) {
+        if (column.attr->type == Types::Tag::Char) {
+            value.erase(0, value.find_first_not_of(' ') == string::npos ? value.size() : value.find_first_not_of(' '));
+        }
+        if (value.size() <= column.attr->len1) {
+            constants.push_back(value);
+        }
+    }
+    switch (column.storage) {
+        case Storage::String8:
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectStringIn<uint8_t>(values, stride, b.rows[slot].data(), sel, n, constants.data(), (unsigned) constants.size(), out);
+            };
+        case Storage::String16:
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectStringIn<uint16_t>(values, stride, b.rows[slot].data(), sel, n, constants.data(), (unsigned) constants.size(), out);
+            };
+        default:
+            return [=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::selectStringIn<uint32_t>(values, stride, b.rows[slot].data(), sel, n, constants.data(), (unsigned) constants.size(), out);
+            };
+    }
+}
+
+unique_ptr<Interpreter::Node> Interpreter::translate(Operator& op) {
+    if (auto scan = dynamic_cast<TableScan*>(&op)) {
+        const unsigned s = slot(scan);
+        return unique_ptr<Node>(new Scan(s, layouts[s].count));
+    }
+
+    //The selection on top checks all conditions of the index access
+    if (auto index = dynamic_cast<IndexScan*>(&op)) {
+        return translate(*index->scan);
+    }
+
+    if (auto selection = dynamic_cast<Selection*>(&op)) {
+        auto input = translate(*selection->input);
+        if (!input) {
+            return nullptr;
+        }
+        vector<Condition> conditions;
+
+        //Only the versions valid at the given time or now, as in Selection::consume
+        if (selection->sysTimeStartIU != nullptr && selection->sysTimeEndIU != nullptr) {
+            const Column start = column(selection->sysTimeStartIU), end = column(selection->sysTimeEndIU);
+            const Timestamp from = selection->sysTimeStart, to = selection->sysTimeEnd;
+            const uint64_t now = Timestamp::now().value;
+            if (from == Timestamp::null() && to != Timestamp::null()) {
+                throw "Missing start timestamp for ranged query";
+            }
+            conditions.push_back([=](const Batch& b, const uint32_t* sel, unsigned n, uint32_t* out) {
+                return Kernels::select(b.rows[start.slot].data(), sel, n, out, [&](uint32_t row) {
+                    const uint64_t s = Kernels::value<uint64_t>(start.values, start.stride, row);
+                    const uint64_t e = Kernels::value<uint64_t>(end.values, end.stride, row);
+                    if (from != Timestamp::null() && to == Timestamp::null()) {
+                        return (s <= from.value && e >= from.value) || (s <= now && e == 0);
+                    } else if (from != Timestamp::null()) {
+                        return !(e < from.value || s > to.value) || (s < to.value && e == 0);
+                    }
+                    return s <= now && e == 0;
+                });
+            });
+        }
+
+        for (auto& c : selection->conditions) {
+            auto condition = this->condition(column(c.first), c.second);
+            if (!condition) {
+                return nullptr;
+            }
+            conditions.push_back(move(condition));
+        }
+        return unique_ptr<Node>(new Filter(move(input), move(conditions)));
+    }
+
+    //Build on the left side, probe with the right side. An index join looks up the outer tuples, so it builds on the inner
+    Operator* build = nullptr;
+    Operator* probe = nullptr;
+    vector<tuple<IU*, IU*>> conditions;
+    if (auto join = dynamic_cast<HashJoin*>(&op)) {
+        build = &join->left;
+        probe = &join->right;
+        conditions = join->conditions;
+    } else if (auto join = dynamic_cast<IndexJoin*>(&op)) {
+        build = &join->inner;
+        probe = &join->outer;
+        for (auto& c : join->conditions) {
+            conditions.emplace_back(get<1>(c), get<0>(c));
+        }
+    } else {
+        return nullptr;
+    }
+
+    auto buildNode = translate(*build);
+    auto probeNode = translate(*probe);
+    if (!buildNode || !probeNode) {
+        return nullptr;
+    }
+    vector<Column> buildKeys, probeKeys;
+    for (auto& c : conditions) {
+        //The generated code compares values of the same type, other keys do not compile
+        auto a = get<0>(c)->attr, b = get<1>(c)->attr;
+        if (a->type != b->type || a->len1 != b->len1 || a->len2 != b->len2) {
+            return nullptr;
+        }
+        //The IUs of a condition are found by name, on either side
+        const bool swapped = find(buildNode->slots.begin(), buildNode->slots.end(), slot(get<0>(c)->rel)) == buildNode->slots.end();
+        buildKeys.push_back(column(swapped ? get<1>(c) : get<0>(c)));
+        probeKeys.push_back(column(swapped ? get<0>(c) : get<1>(c)));
+    }
+    return unique_ptr<Node>(new Join(move(buildNode), move(probeNode), move(buildKeys), move(probeKeys)));
+}
+
+vector<uint32_t> Interpreter::collect(Node& input) {
+    Batch batch;
+    batch.rows.resize(scans.size());
+    vector<uint32_t> rows;
+    while (input.next(batch)) {
+        rows.insert(rows.end(), batch.rows[0].begin(), batch.rows[0].end());
+    }
+    return rows;
+}
+
+bool Interpreter::run(Print& print) {
+    auto input = translate(print.input);
+    if (!input) {
+        return false;
+    }
+    vector<Column> columns;
+    vector<int> widths;
+    for (auto iu : print.outVars) {
+        columns.push_back(column(iu));
+        widths.push_back(getColumnWidth(iu->attr));
+    }
+
+    cout << "\033[1;32m" << setfill(' ');
+    for (size_t c = 0; c < columns.size(); c++) {
+        cout << setw(widths[c]) << left << columns[c].attr->name;
+    }
+    cout << "\033[0m" << endl;
+
+    Batch batch;
+    batch.rows.resize(scans.size());
+    while (input->next(batch)) {
+        for (unsigned i = 0; i < batch.size; i++) {
+            cout << setfill(' ');
+            for (size_t c = 0; c < columns.size(); c++) {
+                cout << setw(widths[c]) << left;
+                ::print(cout, columns[c], batch.rows[columns[c].slot][i]);
+            }
+            cout << endl;
+        }
+    }
+    return true;
+}
+
+bool Interpreter::run(Update& update) {
+    //Only tables with a key or versions can be updated
+    if (update.relation.primaryKey.empty() && !update.relation.systemVersioning) {
+        return false;
+    }
+    auto input = translate(update.input);
+    if (!input || scans.size() != 1) {
+        return false;
+    }
+
+    //The new values are cast when the rows are updated, the parameters of SET come first
+    vector<pair<size_t, string>> values;
+    unsigned currentVar = 0;
+    for (auto& field : update.outVars) {
+        const size_t index = field.first->attr - scans[0]->getRelation().attributes.data();
+        values.emplace_back(index, field.second == "?" ? params.at(currentVar++) : field.second);
+    }
+    updateRows(db, update.relation.name, collect(*input), values);
+    return true;
+}
+
+bool Interpreter::run(Delete& remove) {
+    if (remove.rel.primaryKey.empty()) {
+        return false;
+    }
+    auto input = translate(remove.input);
+    if (!input || scans.size() != 1) {
+        return false;
+    }
+    removeRows(db, remove.rel.name, collect(*input));
+    return true;
+}
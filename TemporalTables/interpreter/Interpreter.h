@@ -0,0 +1,109 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../operators/Operator.h"
+#include "../query/Predicate.h"
+#include "../utils/TableLayout.h"
+
+using namespace std;
+
+struct Database;
+class TableScan;
+class Print;
+class Update;
+class Delete;
+
+/// Runs the plan of a query batch at a time instead of generating code for it and compiling it
+///
+/// The operators of the plan are translated into nodes that pass batches of tuples to each other, a tuple being the
+/// row of every scan below. The selections and joins evaluate their conditions on a whole batch with the kernels for
+/// the type of the column, only the operator at the top reads the tuples one by one. Plans with an aggregation or a
+/// sort are not supported, index scans and index joins are interpreted as table scans and hash joins.
+class Interpreter {
+public:
+    /// Tuples per batch of a scan
+    static const unsigned batchSize = 1024;
+
+    /// How the values of a column are stored: the raw value of the type or a string with a length of the given size
+    enum class Storage {
+        Int64, Int32, UInt64, Char, String8, String16, String32
+    };
+
+    /// A column of a scan in the plan, values points to its value in the first row of the table
+    struct Column {
+        Schema::Relation::Attribute* attr;
+        Storage storage;
+        unsigned slot;
+        const char* values;
+        size_t stride;
+    };
+
+    /// The indexes of the rows of the tables for the tuples of a batch, per slot of a scan
+    struct Batch {
+        unsigned size = 0;
+        vector<vector<uint32_t>> rows;
+    };
+
+    /// Keeps the positions of the tuples of a batch that qualify, returns their number
+    using Condition = function<unsigned(const Batch&, const uint32_t* sel, unsigned n, uint32_t* out)>;
+
+    class Node {
+    public:
+        /// Slots of the scans below
+        vector<unsigned> slots;
+
+        virtual ~Node() { }
+
+        /// Set the tuples of the next batch in the slots, false if there are none left. A batch is never empty.
+        virtual bool next(Batch& batch) = 0;
+    };
+
+private:
+    Database* db;
+    const vector<string>& params;
+
+    void (* tableLayout)(Database*, const string&, TableLayout&);
+    void (* removeRows)(Database*, const string&, const vector<uint32_t>&);
+    void (* updateRows)(Database*, const string&, const vector<uint32_t>&, const vector<pair<size_t, string>>&);
+
+    /// The scans of the plan by their slot, with the rows of their table when the plan was translated
+    vector<TableScan*> scans;
+    vector<TableLayout> layouts;
+
+    unsigned slot(TableScan* scan);
+
+    Column column(IU* iu);
+
+    static Storage storage(const Schema::Relation::Attribute& attr);
+
+    /// The condition of a selection, nullptr if the type of the column does not support it
+    Condition condition(const Column& column, const Predicate& predicate);
+
+    /// The condition of an IN selection with the values of its list
+    Condition inCondition(const Column& column, const vector<string>& list);
+
+    /// The node running an operator and its inputs, nullptr if an operator is not supported
+    unique_ptr<Node> translate(Operator& op);
+
+    /// The rows of the only scan for all tuples of the input
+    vector<uint32_t> collect(Node& input);
+
+public:
+    /// The functions accessing the tables are looked up in the library of the database
+    Interpreter(Database* db, void* library, const vector<string>& params);
+
+    /// Run the plan below the operator. Returns false without running anything if an operator of the plan is not
+    /// supported, the query has to be compiled then.
+    bool run(Print& print);
+
+    bool run(Update& update);
+
+    bool run(Delete& remove);
+};
+
+#endif //INTERPRETER_H
@@ -0,0 +1,209 @@
+#ifndef INTERPRETER_KERNELS_H
+#define INTERPRETER_KERNELS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include "../utils/Types.hpp"
+#include "../query/Predicate.h"
+
+//---------------------------------------------------------------------------
+// Kernels of the interpreter
+//
+// The values of a column are at the same offset in every row of its table, `column` points to the value in the first
+// row and `stride` is the size of a row. A kernel works on the tuples of a batch given by the positions in `sel`,
+// `rows` are the indexes of the rows of the table for all tuples of the batch. The positions of the qualifying tuples
+// are written to `out`, which may be `sel`, and their number is returned. There is one instantiation per raw type:
+// int64_t for Integer and Numeric, int32_t for Date, uint64_t for Timestamp and char for Char<1>. Char and Varchar
+// are instantiated by the type of their length, which is followed by the characters.
+//---------------------------------------------------------------------------
+struct Kernels {
+    template<class T>
+    static const T& value(const char* column, size_t stride, uint32_t row) {
+        return *reinterpret_cast<const T*>(column + row * stride);
+    }
+
+    /// Keep the tuples for which the predicate on the row holds
+    template<class Predicate>
+    static unsigned select(const uint32_t* rows, const uint32_t* sel, unsigned n, uint32_t* out, Predicate predicate) {
+        unsigned found = 0;
+        for (unsigned i = 0; i < n; i++) {
+            out[found] = sel[i];
+            found += predicate(rows[sel[i]]);
+        }
+        return found;
+    }
+
+    template<class T>
+    static unsigned selectEqual(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                                T constant, uint32_t* out) {
+        return select(rows, sel, n, out, [=](uint32_t row) { return value<T>(column, stride, row) == constant; });
+    }
+
+    template<class T, class Compare>
+    static unsigned selectCompare(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                                  T constant, Compare compare, uint32_t* out) {
+        return select(rows, sel, n, out, [=](uint32_t row) { return compare(value<T>(column, stride, row), constant); });
+    }
+
+    /// Keep the tuples whose value compares to the constant as the operator says, the loop is chosen once per batch
+    template<class T>
+    static unsigned selectCompare(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                                  CompareOp op, T constant, uint32_t* out) {
+        switch (op) {
+            case CompareOp::NotEqual:
+                return selectCompare(column, stride, rows, sel, n, constant, std::not_equal_to<T>(), out);
+            case CompareOp::Less:
+                return selectCompare(column, stride, rows, sel, n, constant, std::less<T>(), out);
+            case CompareOp::LessEqual:
+                return selectCompare(column, stride, rows, sel, n, constant, std::less_equal<T>(), out);
+            case CompareOp::Greater:
+                return selectCompare(column, stride, rows, sel, n, constant, std::greater<T>(), out);
+            case CompareOp::GreaterEqual:
+                return selectCompare(column, stride, rows, sel, n, constant, std::greater_equal<T>(), out);
+            default:
+                return selectEqual(column, stride, rows, sel, n, constant, out);
+        }
+    }
+
+    /// Longest list of an IN that is compared with every value instead of being searched
+    static constexpr unsigned smallList = 8;
+
+    /// Keep the tuples whose value is one of the sorted constants, the loop is chosen once per batch
+    template<class T>
+    static unsigned selectIn(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                             const T* constants, unsigned count, uint32_t* out) {
+        if (count <= smallList) {
+            return select(rows, sel, n, out, [=](uint32_t row) {
+                const T v = value<T>(column, stride, row);
+                bool found = false;
+                for (unsigned i = 0; i < count; i++) {
+                    found |= v == constants[i];
+                }
+                return found;
+            });
+        }
+        return select(rows, sel, n, out, [=](uint32_t row) {
+            return std::binary_search(constants, constants + count, value<T>(column, stride, row));
+        });
+    }
+
+    template<class Length>
+    static unsigned selectStringIn(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                                   const std::string* constants, unsigned count, uint32_t* out) {
+        return select(rows, sel, n, out, [=](uint32_t row) {
+            const char* s = column + row * stride;
+            const Length len = *reinterpret_cast<const Length*>(s);
+            for (unsigned i = 0; i < count; i++) {
+                if (constants[i].size() == len && memcmp(s + sizeof(Length), constants[i].data(), len) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+
+    /// Order of two strings as in the comparison of Char and Varchar, negative if a is before b
+    static int compareString(const char* a, unsigned aLen, const char* b, unsigned bLen) {
+        const int c = memcmp(a, b, std::min(aLen, bLen));
+        return c != 0 ? c : (aLen > bLen) - (aLen < bLen);
+    }
+
+    /// If the order of two values satisfies a comparison, for a string compared by compareString
+    static bool satisfies(CompareOp op, int order) {
+        switch (op) {
+            case CompareOp::NotEqual:
+                return order != 0;
+            case CompareOp::Less:
+                return order < 0;
+            case CompareOp::LessEqual:
+                return order <= 0;
+            case CompareOp::Greater:
+                return order > 0;
+            case CompareOp::GreaterEqual:
+                return order >= 0;
+            default:
+                return order == 0;
+        }
+    }
+
+    template<class Length>
+    static unsigned selectStringCompare(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                                        CompareOp op, const char* str, unsigned len, uint32_t* out) {
+        return select(rows, sel, n, out, [=](uint32_t row) {
+            const char* s = column + row * stride;
+            return satisfies(op, compareString(s + sizeof(Length), *reinterpret_cast<const Length*>(s), str, len));
+        });
+    }
+
+    template<class Length>
+    static unsigned selectStringEqual(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                                      const char* str, unsigned len, uint32_t* out) {
+        return select(rows, sel, n, out, [=](uint32_t row) {
+            const char* s = column + row * stride;
+            return *reinterpret_cast<const Length*>(s) == len && memcmp(s + sizeof(Length), str, len) == 0;
+        });
+    }
+
+    template<class Length>
+    static unsigned selectStringLike(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                                     const char* pattern, unsigned patternLen, uint32_t* out) {
+        return select(rows, sel, n, out, [=](uint32_t row) {
+            const char* s = column + row * stride;
+            return likeMatch(s + sizeof(Length), *reinterpret_cast<const Length*>(s), pattern, patternLen);
+        });
+    }
+
+    /// LIKE on a Char<1>, a space is the empty string
+    static unsigned selectCharLike(const char* column, size_t stride, const uint32_t* rows, const uint32_t* sel, unsigned n,
+                                   const char* pattern, unsigned patternLen, uint32_t* out) {
+        return select(rows, sel, n, out, [=](uint32_t row) {
+            const char c = value<char>(column, stride, row);
+            return likeMatch(&c, c != ' ', pattern, patternLen);
+        });
+    }
+
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /// Combine the hashes of the first n tuples with the values of a key column
+    template<class T>
+    static void hash(const char* column, size_t stride, const uint32_t* rows, unsigned n, uint64_t* hashes) {
+        for (unsigned i = 0; i < n; i++) {
+            hashes[i] = mix(hashes[i] ^ (uint64_t) value<T>(column, stride, rows[i]));
+        }
+    }
+
+    template<class Length>
+    static void hashString(const char* column, size_t stride, const uint32_t* rows, unsigned n, uint64_t* hashes) {
+        for (unsigned i = 0; i < n; i++) {
+            const char* s = column + rows[i] * stride;
+            const Length len = *reinterpret_cast<const Length*>(s);
+            uint64_t h = hashes[i] ^ len;
+            for (unsigned c = 0; c < len; c++) {
+                h = h * 31 + (unsigned char) s[sizeof(Length) + c];
+            }
+            hashes[i] = mix(h);
+        }
+    }
+
+    /// Compare the values of a key column of two rows, a and b point to the values
+    template<class T>
+    static bool equal(const char* a, const char* b) {
+        return *reinterpret_cast<const T*>(a) == *reinterpret_cast<const T*>(b);
+    }
+
+    template<class Length>
+    static bool equalString(const char* a, const char* b) {
+        const Length len = *reinterpret_cast<const Length*>(a);
+        return len == *reinterpret_cast<const Length*>(b) && memcmp(a + sizeof(Length), b + sizeof(Length), len) == 0;
+    }
+};
+
+#endif //INTERPRETER_KERNELS_H
@@ -0,0 +1,316 @@
+#include <sstream>
+#include <cctype>
+#include "Aggregate.h"
+#include "../parser/IU.h"
+#include "../parser/ParserError.h"
+
+using namespace std;
+
+static string powerOfTen(unsigned exponent) {
+    return "1" + string(exponent, '0');
+}
+
+/// Bring a raw value to more decimal places
+static pair<string, unsigned> align(const pair<string, unsigned>& value, unsigned scale) {
+    if (value.second == scale) {
+        return value;
+    }
+    return make_pair("(" + value.first + " * " + powerOfTen(scale - value.second) + ")", scale);
+}
+
+static bool isColumn(const string& token) {
+    return !token.empty() && (isalpha(token[0]) || token[0] == '_');
+}
+
+Aggregate::Aggregate(Operator& input, const vector<IU*>& groupBy, const vector<AggregateItem>& items)
+        : input(input), groupBy(groupBy), suffix(Operator::randomEntityName()) {
+    input.setConsumer(this);
+    for (auto iu : groupBy) {
+        this->required.insert(iu);
+        this->produced.insert(iu);
+    }
+
+    for (auto& item : items) {
+        Function function{item.op, "", "", -1, stateTypes.size(), nullptr};
+        Schema::Relation::Attribute attr;
+        if (item.op == AggregateOp::Count) {
+            attr.type = Types::Tag::Integer;
+            stateTypes.push_back("int64_t");
+        } else if ((item.op == AggregateOp::Min || item.op == AggregateOp::Max) && item.argument.size() == 1 && isColumn(item.argument[0])) {
+            //The minimum and maximum of a column work for every type that can be compared, and keep it
+            IU* iu = findInput(item.argument[0]);
+            this->required.insert(iu);
+            function.value = iu->attr->name;
+            function.type = Schema::type(*iu->attr, 1);
+            attr.type = iu->attr->type;
+            attr.len1 = iu->attr->len1;
+            attr.len2 = iu->attr->len2;
+            stateTypes.push_back(function.type);
+        } else {
+            size_t pos = 0;
+            auto expression = compileExpression(item.argument, pos);
+            if (pos != item.argument.size()) {
+                throw ParserError(0, "Unexpected '" + item.argument[pos] + "' in the argument of " + item.name);
+            }
+            function.value = expression.first;
+            function.type = "int64_t";
+            function.scale = expression.second;
+
+            //The average gets two more decimal places than its argument
+            const unsigned scale = expression.second + (item.op == AggregateOp::Avg ? 2 : 0);
+            attr.type = scale == 0 ? Types::Tag::Integer : Types::Tag::Numeric;
+            attr.len1 = 18;
+            attr.len2 = scale;
+            stateTypes.push_back("int64_t");
+            if (item.op == AggregateOp::Avg) {
+                stateTypes.push_back("int64_t");
+            }
+        }
+        attr.name = item.name;
+        function.output = addOutput(attr);
+        functions.push_back(function);
+    }
+}
+
+Aggregate::~Aggregate() {
+    for (auto iu : outputs) {
+        delete iu->attr;
+        delete iu;
+    }
+}
+
+IU* Aggregate::findInput(const string& name) {
+    for (auto iu : input.getProduced()) {
+        if (iu->attr->name == name) {
+            return iu;
+        }
+    }
+    throw ParserError(5, "Attribute not found: '" + name + "'");
+}
+
+IU* Aggregate::addOutput(const Schema::Relation::Attribute& attr) {
+    auto iu = new IU{nullptr, new Schema::Relation::Attribute(attr)};
+    outputs.push_back(iu);
+    this->produced.insert(iu);
+    return iu;
+}
+
+pair<string, unsigned> Aggregate::compileExpression(const vector<string>& tokens, size_t& pos) {
+    auto result = compileTerm(tokens, pos);
+    while (pos < tokens.size() && (tokens[pos] == "+" || tokens[pos] == "-")) {
+        const string op = tokens[pos++];
+        auto right = compileTerm(tokens, pos);
+        const unsigned scale = max(result.second, right.second);
+        result = make_pair("(" + align(result, scale).first + " " + op + " " + align(right, scale).first + ")", scale);
+    }
+    return result;
+}
+
+pair<string, unsigned> Aggregate::compileTerm(const vector<string>& tokens, size_t& pos) {
+    auto result = compileFactor(tokens, pos);
+    while (pos < tokens.size() && tokens[pos] == "*") {
+        pos++;
+        auto right = compileFactor(tokens, pos);
+        result = make_pair("(" + result.first + " * " + right.first + ")", result.second + right.second);
+    }
+    return result;
+}
+
+pair<string, unsigned> Aggregate::compileFactor(const vector<string>& tokens, size_t& pos) {
+    if (pos >= tokens.size()) {
+        throw ParserError(0, "Incomplete arithmetic expression in aggregate");
+    }
+    const string token = tokens[pos++];
+    if (token == "-") {
+        auto value = compileFactor(tokens, pos);
+        return make_pair("(-" + value.first + ")", value.second);
+    }
+    if (token == "(") {
+        auto value = compileExpression(tokens, pos);
+        if (pos >= tokens.size() || tokens[pos] != ")") {
+            throw ParserError(0, "Missing ')' in aggregate");
+        }
+        pos++;
+        return value;
+    }
+    if (isdigit(token[0])) {
+        //Constants are raw values too, 0.05 is 5 with two decimal places
+        const size_t dot = token.find('.');
+        string digits = token;
+        unsigned scale = 0;
+        if (dot != string::npos) {
+            digits = token.substr(0, dot) + token.substr(dot + 1);
+            scale = (unsigned) (token.size() - dot - 1);
+        }
+        //No leading zeros, they would make it an octal literal
+        const size_t first = digits.find_first_not_of('0');
+        digits = first == string::npos ? "0" : digits.substr(first);
+        return make_pair(digits, scale);
+    }
+    if (!isColumn(token)) {
+        throw ParserError(0, "Unexpected '" + token + "' in aggregate");
+    }
+
+    IU* iu = findInput(token);
+    this->required.insert(iu);
+    if (iu->attr->type == Types::Tag::Integer) {
+        return make_pair(token + ".value", 0u);
+    }
+    if (iu->attr->type == Types::Tag::Numeric) {
+        return make_pair(token + ".value", iu->attr->len2);
+    }
+    throw ParserError(0, "Only integer and numeric columns can be used in arithmetic: '" + token + "'");
+}
+
+string Aggregate::initState() const {
+    stringstream out;
+    out << "std::tuple<";
+    for (auto& type : stateTypes) {
+        out << type << (&type != &stateTypes.back() ? ", " : "");
+    }
+    out << ">(";
+    for (auto& f : functions) {
+        out << (&f != &functions.front() ? ", " : "");
+        if (f.op == AggregateOp::Count) {
+            out << "1";
+        } else if (f.op == AggregateOp::Avg) {
+            out << f.value << ", 1";
+        } else {
+            out << f.value;
+        }
+    }
+    out << ")";
+    return out.str();
+}
+
+string Aggregate::updateState(const string& state) const {
+    stringstream out;
+    for (auto& f : functions) {
+        const string slot = "std::get<" + to_string(f.slot) + ">(" + state + ")";
+        switch (f.op) {
+            case AggregateOp::Count:
+                out << slot << "++;" << endl;
+                break;
+            case AggregateOp::Sum:
+                out << slot << " += " << f.value << ";" << endl;
+                break;
+            case AggregateOp::Min:
+            case AggregateOp::Max: {
+                const string v = "value" + suffix + to_string(f.slot);
+                out << "{ const " << f.type << " " << v << " = " << f.value << "; ";
+                if (f.op == AggregateOp::Min) {
+                    out << "if (" << v << " < " << slot << ") { " << slot << " = " << v << "; } }" << endl;
+                } else {
+                    out << "if (" << slot << " < " << v << ") { " << slot << " = " << v << "; } }" << endl;
+                }
+                break;
+            }
+            case AggregateOp::Avg:
+                out << slot << " += " << f.value << ";" << endl;
+                out << "std::get<" << f.slot + 1 << ">(" << state << ")++;" << endl;
+                break;
+        }
+    }
+    return out.str();
+}
+
+string Aggregate::produce() {
+    const string state = "state" + suffix, seen = "seen" + suffix, groups = "groups" + suffix, group = "group" + suffix;
+    stringstream stateType;
+    stateType << "std::tuple<";
+    for (auto& type : stateTypes) {
+        stateType << type << (&type != &stateTypes.back() ? ", " : "");
+    }
+    stateType << ">";
+
+    //Bind the aggregates of a group for the consumer
+    stringstream bindings;
+    for (auto& f : functions) {
+        const string slot = "std::get<" + to_string(f.slot) + ">(" + state + ")";
+        const string& name = f.output->attr->name;
+        if (f.scale < 0 && f.op != AggregateOp::Count) {
+            bindings << "const auto& " << name << " = " << slot << ";" << endl;
+        } else if (f.op == AggregateOp::Avg) {
+            bindings << Schema::type(*f.output->attr, 1) << " " << name << "(" << slot << " * 100 / std::get<" << f.slot + 1 << ">(" << state << "));" << endl;
+        } else {
+            bindings << Schema::type(*f.output->attr, 1) << " " << name << "(" << slot << ");" << endl;
+        }
+    }
+
+    stringstream out;
+    if (groupBy.empty()) {
+        //Counts and sums are 0 for an empty input, the other aggregates have no value then and no row is output
+        bool emptyRow = true;
+        for (auto& f : functions) {
+            emptyRow &= f.op == AggregateOp::Count || f.op == AggregateOp::Sum;
+        }
+        out << stateType.str() << " " << state << "{};" << endl;
+        out << "bool " << seen << " = false;" << endl;
+        out << input.produce();
+        out << "if (" << (emptyRow ? "true" : seen) << ") { //Start aggregate output" << endl;
+        out << bindings.str();
+        out << passOn();
+        out << "} //End aggregate output" << endl;
+        return out.str();
+    }
+
+    out << "HashAggregationTable<std::tuple<";
+    for (auto iu : groupBy) {
+        out << Schema::type(*iu->attr, 1) << (iu != groupBy.back() ? ", " : "");
+    }
+    out << ">, " << stateType.str() << "> " << groups << ";" << endl;
+    out << input.produce();
+    stringstream output;
+    output << "for (auto& " << group << " : " << groups << ") { //Start aggregate output" << endl;
+    for (size_t i = 0; i < groupBy.size(); i++) {
+        output << "const auto& " << groupBy[i]->attr->name << " = std::get<" << i << ">(" << group << ".key);" << endl;
+    }
+    output << "const auto& " << state << " = " << group << ".value;" << endl;
+    output << bindings.str();
+    output << passOn();
+    output << "} //End aggregate output" << endl;
+    out << timed(output.str());
+    return out.str();
+}
+
+string Aggregate::describe() const {
+    stringstream out;
+    out << "Aggregate";
+    for (auto& f : functions) {
+        out << (&f != &functions.front() ? ", " : " ") << f.output->attr->name;
+    }
+    if (!groupBy.empty()) {
+        out << " GROUP BY";
+        for (auto iu : groupBy) {
+            out << (iu != groupBy.front() ? ", " : " ") << iu->attr->name;
+        }
+    }
+    return out.str();
+}
+
+vector<Operator*> Aggregate::inputs() {
+    return {&input};
+}
+
+string Aggregate::consume(Operator&) {
+    const string state = "state" + suffix, seen = "seen" + suffix, groups = "groups" + suffix;
+    stringstream out;
+    if (groupBy.empty()) {
+        out << "if (" << seen << ") {" << endl;
+        out << updateState(state);
+        out << "} else {" << endl;
+        out << state << " = " << initState() << ";" << endl;
+        out << seen << " = true;" << endl;
+        out << "}" << endl;
+        return out.str();
+    }
+
+    out << groups << ".aggregate(std::make_tuple(";
+    for (auto iu : groupBy) {
+        out << iu->attr->name << (iu != groupBy.back() ? ", " : "");
+    }
+    out << "), [&]() { return " << initState() << "; }, [&](auto& " << state << ") {" << endl;
+    out << updateState(state);
+    out << "});" << endl;
+    return out.str();
+}
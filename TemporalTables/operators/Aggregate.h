@@ -0,0 +1,65 @@
+#ifndef TASK4_AGGREGATE_H
+#define TASK4_AGGREGATE_H
+
+
+#include "Operator.h"
+#include "../query/Aggregation.h"
+
+using namespace std;
+
+/// Hash aggregation, groups the input by the group by columns and computes the aggregates of every group.
+/// Without group by columns the state is kept in local variables instead of a hash table.
+class Aggregate : public Operator {
+    /// An aggregate as it is computed
+    struct Function {
+        AggregateOp op;
+        /// C++ expression of the argument for the current tuple
+        string value;
+        /// Type of the value, int64_t for the raw value of an arithmetic expression
+        string type;
+        /// Decimal places of the raw value, -1 if the argument is a single column kept in its own type
+        int scale;
+        /// Position of the state in the state tuple
+        size_t slot;
+        IU* output;
+    };
+
+    Operator& input;
+    vector<IU*> groupBy;
+    vector<Function> functions;
+    /// Types of the state of all aggregates, avg keeps its sum and its count
+    vector<string> stateTypes;
+    /// IUs of the aggregates, owned by the operator
+    vector<IU*> outputs;
+    string suffix;
+
+    /// Compile an arithmetic expression into int64_t arithmetic on raw values, returns the code and its decimal places
+    pair<string, unsigned> compileExpression(const vector<string>& tokens, size_t& pos);
+    pair<string, unsigned> compileTerm(const vector<string>& tokens, size_t& pos);
+    pair<string, unsigned> compileFactor(const vector<string>& tokens, size_t& pos);
+
+    IU* findInput(const string& name);
+
+    IU* addOutput(const Schema::Relation::Attribute& attr);
+
+    string initState() const;
+
+    string updateState(const string& state) const;
+
+public:
+    Aggregate(Operator& input, const vector<IU*>& groupBy, const vector<AggregateItem>& items);
+
+    ~Aggregate() override;
+
+    string produce() override;
+
+    string consume(Operator&) override;
+
+    string describe() const override;
+
+protected:
+    vector<Operator*> inputs() override;
+};
+
+
+#endif //TASK4_AGGREGATE_H
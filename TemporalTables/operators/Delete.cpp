@@ -23,6 +23,9 @@ string Delete::produce() {
     if (selections.size() == rel.primaryKey.size()) {
         bool canDoPK = true;
         for (auto& e : selections) {
+            if (e.second.op != CompareOp::Equal) {
+                canDoPK = false;
+            }
             bool found = false;
             for (auto& a : rel.primaryKey) {
                 if (e.first->attr->name == rel.attributes[a].name) {
@@ -41,17 +44,14 @@ string Delete::produce() {
 
             //Create the PK tuple
             keyTuple << "make_tuple(";
-            int paramOffset = 0;
             for (auto& pkAttrKey : rel.primaryKey) {
                 for (auto& selection : selections) {
                     if (selection.first->attr->name == rel.attributes[pkAttrKey].name) {
                         if (selection.first->attr->type == Types::Tag::Integer) {
-                            if(selection.second == "?") {
-                                keyTuple << Schema::type(*selection.first->attr, true) << "::castString(";
-                                keyTuple << "params[" << paramOffset << "].c_str(), " << "params[" << paramOffset << "].size())";
-                                paramOffset++;
+                            if(selection.second.value == "?") {
+                                keyTuple << parameter(selection.second.param, Schema::type(*selection.first->attr, true));
                             }else{
-                                keyTuple << selection.second;
+                                keyTuple << selection.second.value;
                             }
                         } else {
                             throw ParserError(0, "Type in key not supported in deletes");
@@ -92,3 +92,10 @@ string Delete::consume(Operator& op) {
     return out.str();
 }
 
+string Delete::describe() const {
+    return "Delete " + rel.name;
+}
+
+vector<Operator*> Delete::inputs() {
+    return {&input};
+}
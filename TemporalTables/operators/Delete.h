@@ -10,6 +10,8 @@
 using fieldType = pair<IU*, string>;
 
 class Delete : Operator {
+    friend class Interpreter;
+
     Operator& input;
     selectionType selections;
     Schema::Relation rel;
@@ -20,6 +22,11 @@ public:
     string produce() override;
 
     string consume(Operator&) override;
+
+    string describe() const override;
+
+protected:
+    vector<Operator*> inputs() override;
 };
 
 
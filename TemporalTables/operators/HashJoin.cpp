@@ -23,6 +23,42 @@ HashJoin::HashJoin(Operator& left, Operator& right, vector<tuple<IU*, IU*>> cond
     this->produced.insert(right.getProduced().begin(), right.getProduced().end());
 }
 
+string HashJoin::probeKey() const {
+    stringstream out;
+    for (auto& c : conditions) {
+        out << get<1>(c)->attr->name << (c != conditions.back() ? "," : "");
+    }
+    return out.str();
+}
+
+string HashJoin::filterCondition() const {
+    return mapName + ".mayContain({" + probeKey() + "})";
+}
+
+bool HashJoin::pushFilter(const string& condition, const set<IU*>& ius) {
+    //Both sides are produced after the hash table of the join above is finalized, the build side can be filtered too
+    if (left.producesAll(ius)) {
+        return left.pushFilter(condition, ius);
+    }
+    if (right.producesAll(ius)) {
+        return right.pushFilter(condition, ius);
+    }
+    return false;
+}
+
+string HashJoin::describe() const {
+    stringstream out;
+    out << "HashJoin";
+    for (auto& c : conditions) {
+        out << (&c != &conditions.front() ? " AND " : " ") << get<0>(c)->attr->name << "=" << get<1>(c)->attr->name;
+    }
+    return out.str();
+}
+
+vector<Operator*> HashJoin::inputs() {
+    return {&left, &right};
+}
+
 set<IU*> HashJoin::intersectDeps() {
     auto deps = consumer->getRequired();
     set<IU*> intersect;
@@ -37,7 +73,7 @@ string HashJoin::produce() {
     stringstream out;
     stringstream comment;
     comment << "// Fields: ";
-    out << "unordered_multimap<tuple<";
+    out << "HashJoinTable<tuple<";
     for (auto& c : conditions) {
         out << Schema::type(*get<0>(c)->attr, 1);
         comment << get<0>(c)->attr->name << ", ";
@@ -57,6 +93,14 @@ string HashJoin::produce() {
     }
     out << ">> " << mapName << "; " << endl << comment.str() << endl;
     out << left.produce();
+    out << timed(mapName + ".finalize();\n");
+
+    //Let the probe side drop the tuples without a match as early as possible, in its scan if it can
+    set<IU*> probeIUs;
+    for (auto& c : conditions) {
+        probeIUs.insert(get<1>(c));
+    }
+    filterPushed = right.pushFilter(filterCondition(), probeIUs);
     out << right.produce();
 
     return out.str();
@@ -65,7 +109,7 @@ string HashJoin::produce() {
 string HashJoin::consume(Operator& op) {
     stringstream out;
     if (&op == &left) {
-        out << mapName << ".insert({{";
+        out << mapName << ".insert({";
         for (auto& c : conditions) {
             out << get<0>(c)->attr->name;
             if (c != *(conditions.end() - 1)) {
@@ -80,25 +124,20 @@ string HashJoin::consume(Operator& op) {
                 out << ",";
             }
         }
-        out << "}});" << endl;
+        out << "});" << endl;
     } else {
-        string range = mapName + "Range";
-        out << "auto " << range << " =" << mapName << ".equal_range({";
-        for (auto& c : conditions) {
-            out << get<1>(c)->attr->name;
-            if (c != *(conditions.end() - 1)) {
-                out << ",";
-            }
+        out << countProbe();
+        if (!filterPushed) {
+            out << "if (" << filterCondition() << ")" << endl;
         }
-        out << "}); " << endl;
-        out << "for_each(" << range << ".first, " << range << ".second, [&](auto& mapElement){ " << endl;
+        out << mapName << ".probe({" << probeKey() << "}, [&](const auto& mapElement) { " << endl;
         auto intersect = intersectDeps();
         int i = 0;
         for (auto& c : intersect) {
-            out << Schema::type(*c->attr, 1) << " " << c->attr->name << " = get<" << i << ">(get<1>(mapElement));" << endl;
+            out << Schema::type(*c->attr, 1) << " " << c->attr->name << " = get<" << i << ">(mapElement);" << endl;
             i++;
         }
-        out << consumer->consume(*this);
+        out << passOn();
         out << "});" << endl;
 
     }
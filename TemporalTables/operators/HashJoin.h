@@ -12,19 +12,36 @@
 using namespace std;
 
 class HashJoin : public  Operator {
+    friend class Interpreter;
+
     Operator& left;
     Operator& right;
     vector<tuple<IU*, IU*>> conditions;
     string mapName;
+    /// The Bloom filter of the hash table is checked by an operator of the probe side
+    bool filterPushed = false;
 
     set<IU*> intersectDeps();
 
+    /// Columns of the probe side in the order of the key
+    string probeKey() const;
+
+    /// Check of the Bloom filter of the hash table for the current probe tuple
+    string filterCondition() const;
+
 public:
     HashJoin(Operator& left, Operator& right, vector<tuple<IU*, IU*>> conditions);
 
     string produce() override;
     string consume(Operator&) override;
 
+    bool pushFilter(const string& condition, const set<IU*>& ius) override;
+
+    string describe() const override;
+
+protected:
+    vector<Operator*> inputs() override;
+
 };
 
 
@@ -0,0 +1,127 @@
+#include <sstream>
+#include <algorithm>
+#include "IndexJoin.h"
+#include "../parser/IU.h"
+
+using namespace std;
+
+/// The IU of the condition that belongs to the scan goes second
+static tuple<IU*, IU*> orient(const tuple<IU*, IU*>& condition, TableScan& scan) {
+    if (get<0>(condition)->rel == &scan) {
+        return make_tuple(get<1>(condition), get<0>(condition));
+    }
+    return condition;
+}
+
+IndexJoin::IndexJoin(Operator& outer, Operator& inner, TableScan& scan, const vector<tuple<IU*, IU*>>& conditions, const Access& access)
+        : outer(outer), inner(inner), scan(scan), access(access) {
+    outer.setConsumer(this);
+    inner.setConsumer(this);
+
+    for (auto& c : conditions) {
+        auto condition = orient(c, scan);
+        this->conditions.push_back(condition);
+        bool inKey = false;
+        for (size_t i = 0; i < access.values.size(); i++) {
+            inKey |= access.columns[i] == get<1>(condition)->attr && access.values[i] == get<0>(condition)->attr->name;
+        }
+        if (!inKey) {
+            residual.push_back(condition);
+            this->required.insert(get<0>(condition));
+            this->required.insert(get<1>(condition));
+        }
+    }
+
+    //The key is computed from the outer tuple
+    for (auto iu : outer.getProduced()) {
+        for (auto& value : access.values) {
+            if (value == iu->attr->name) {
+                this->required.insert(iu);
+            }
+        }
+    }
+
+    this->produced.insert(outer.getProduced().begin(), outer.getProduced().end());
+    this->produced.insert(inner.getProduced().begin(), inner.getProduced().end());
+}
+
+string IndexJoin::produce() {
+    this->required.insert(consumer->getRequired().begin(), consumer->getRequired().end());
+    //The inner side is never produced on its own, but it has to know what to pass on
+    if (&inner != &scan) {
+        inner.getRequired().insert(this->required.begin(), this->required.end());
+    }
+    return outer.produce();
+}
+
+string IndexJoin::consume(Operator& op) {
+    if (&op != &outer) { // Rows of the inner side that passed its selection
+        return passOn();
+    }
+
+    stringstream out;
+    //The rows found in the index are counted as the tuples of the scan
+    out << scan.countTuple();
+    //Bind what the inner selection and the consumers need from the row
+    set<IU*> needed = inner.getRequired();
+    needed.insert(this->required.begin(), this->required.end());
+    for (auto iu : needed) {
+        if (iu->rel == &scan) {
+            out << "auto& " << iu->attr->name << " = r." << iu->attr->name << ";" << endl;
+        }
+    }
+    if (!residual.empty()) {
+        out << "if (";
+        for (auto& c : residual) {
+            out << (&c != &residual.front() ? " && " : "") << get<0>(c)->attr->name << " == " << get<1>(c)->attr->name;
+        }
+        out << ") {" << endl;
+    }
+    if (&inner == &scan) {
+        out << passOn();
+    } else {
+        out << inner.consume(scan);
+    }
+    if (!residual.empty()) {
+        out << "}" << endl;
+    }
+    return countProbe() + IndexScan::lookup(scan.getRelation().name, access, out.str());
+}
+
+string IndexJoin::describe() const {
+    return "IndexJoin " + scan.getRelation().name + "." + access.index;
+}
+
+vector<Operator*> IndexJoin::inputs() {
+    return {&outer, &inner};
+}
+
+bool IndexJoin::pushFilter(const string& condition, const set<IU*>& ius) {
+    return outer.producesAll(ius) && outer.pushFilter(condition, ius);
+}
+
+map<string, string> IndexJoin::knownValues(TableScan& scan, const vector<tuple<IU*, IU*>>& conditions, const selectionType& selections) {
+    map<string, string> values;
+    for (auto& c : conditions) {
+        auto condition = orient(c, scan);
+        IU* left = get<0>(condition);
+        IU* right = get<1>(condition);
+        if (Schema::type(*left->attr, 1) == Schema::type(*right->attr, 1) && !values.count(right->attr->name)) {
+            values[right->attr->name] = left->attr->name;
+        }
+    }
+
+    //Constants and parameters of the selection on the relation
+    for (auto& value : IndexScan::selectionValues(selections)) {
+        values.insert(value);
+    }
+    return values;
+}
+
+set<string> IndexJoin::joinColumns(TableScan& scan, const vector<tuple<IU*, IU*>>& conditions) {
+    set<string> columns;
+    for (auto& c : conditions) {
+        columns.insert(get<1>(orient(c, scan))->attr->name);
+    }
+    return columns;
+}
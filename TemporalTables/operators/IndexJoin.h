@@ -0,0 +1,54 @@
+#ifndef TASK4_INDEXJOIN_H
+#define TASK4_INDEXJOIN_H
+
+
+#include <map>
+#include "Operator.h"
+#include "TableScan.h"
+#include "IndexScan.h"
+#include "../query/Query.h"
+
+using namespace std;
+
+/// Join that looks up the matching rows of a table in its primary key or an ordered index for every outer tuple,
+/// instead of scanning the table and building a hash table
+class IndexJoin : public Operator {
+    friend class Interpreter;
+
+public:
+    using Access = IndexScan::Access;
+
+private:
+    Operator& outer;
+    Operator& inner;
+    TableScan& scan;
+    Access access;
+    /// All join conditions, pairs of outer and inner IU
+    vector<tuple<IU*, IU*>> conditions;
+    /// Join conditions that the key does not check
+    vector<tuple<IU*, IU*>> residual;
+
+public:
+    /// inner is the scan itself or a Selection on top of it, which is evaluated on the rows found in the index
+    IndexJoin(Operator& outer, Operator& inner, TableScan& scan, const vector<tuple<IU*, IU*>>& conditions, const Access& access);
+
+    string produce() override;
+
+    string consume(Operator&) override;
+
+    bool pushFilter(const string& condition, const set<IU*>& ius) override;
+
+    string describe() const override;
+
+    /// Values known for the columns of the scanned relation from the join conditions and equality selections
+    static map<string, string> knownValues(TableScan& scan, const vector<tuple<IU*, IU*>>& conditions, const selectionType& selections);
+
+    /// Columns of the scanned relation used in the join conditions
+    static set<string> joinColumns(TableScan& scan, const vector<tuple<IU*, IU*>>& conditions);
+
+protected:
+    vector<Operator*> inputs() override;
+};
+
+
+#endif //TASK4_INDEXJOIN_H
@@ -0,0 +1,231 @@
+#include <sstream>
+#include <algorithm>
+#include "IndexScan.h"
+#include "../parser/IU.h"
+#include "../parser/ParserError.h"
+
+using namespace std;
+
+IndexScan::IndexScan(shared_ptr<TableScan> scan, const Access& access) : scan(scan), access(access) {
+    this->produced.insert(scan->getProduced().begin(), scan->getProduced().end());
+}
+
+string IndexScan::produce() {
+    stringstream bindings;
+    for (const auto e : consumer->getRequired()) {
+        if (e->rel == scan.get()) {
+            bindings << "auto& " << e->attr->name << " = r." << e->attr->name << ";" << endl;
+        }
+    }
+    return timed(lookup(scan->getRelation().name, access, bindings.str() + passOn()));
+}
+
+string IndexScan::describe() const {
+    string out = "IndexScan " + scan->getRelation().name + "." + access.index;
+    if (access.listing()) {
+        out += " in " + access.columns[access.listed]->name + " (" + to_string(access.list.size()) + " values)";
+    }
+    if (access.ranged()) {
+        out += " range " + access.columns[access.values.size()]->name;
+    }
+    return out;
+}
+
+string IndexScan::consume(Operator&) {
+    throw ParserError(0, "Cannot indexScan cannot consume an operator!");
+}
+
+string IndexScan::lookup(const string& table, const Access& access, const string& body) {
+    const string suffix = Operator::randomEntityName();
+    const string index = "index" + suffix, it = "it" + suffix;
+    const string list = "list" + suffix, value = "value" + suffix;
+
+    //Key with the known values, the lower bound of the range and the smallest possible value for the rest
+    const size_t bounded = access.values.size();
+    stringstream key;
+    key << "std::tuple<";
+    for (size_t i = 0; i < access.columns.size(); i++) {
+        key << Schema::type(*access.columns[i], 1) << (i + 1 < access.columns.size() ? ", " : "");
+    }
+    key << ">(";
+    for (size_t i = 0; i < access.columns.size(); i++) {
+        if (access.listing() && i == access.listed) {
+            key << "*" << value;
+        } else if (i < access.values.size()) {
+            key << access.values[i];
+        } else if (i == bounded && !access.range.lower.empty()) {
+            key << access.range.lower;
+        } else {
+            key << Schema::minValue(*access.columns[i]);
+        }
+        key << (i + 1 < access.columns.size() ? ", " : "");
+    }
+    key << ")";
+
+    stringstream out;
+    out << "{ //Start index lookup: " << table << "." << access.index << endl;
+    out << "auto& " << index << " = db->" << table << "." << access.index << ";" << endl;
+    if (access.listing()) {
+        //Every distinct value is probed once, a value given twice would find its rows twice
+        out << "std::array<" << Schema::type(*access.columns[access.listed], 1) << ", " << access.list.size() << "> " << list << "{{";
+        for (size_t i = 0; i < access.list.size(); i++) {
+            out << access.list[i] << (i + 1 < access.list.size() ? ", " : "");
+        }
+        out << "}};" << endl;
+        out << "std::sort(" << list << ".begin(), " << list << ".end());" << endl;
+        out << "const auto " << list << "End = std::unique(" << list << ".begin(), " << list << ".end());" << endl;
+        out << "for (auto " << value << " = " << list << ".begin(); " << value << " != " << list << "End; ++" << value << ") {" << endl;
+    }
+    if (access.point()) {
+        out << "auto " << it << " = " << index << ".find(" << key.str() << ");" << endl;
+        out << "if (" << it << " != " << index << ".end()) {" << endl;
+    } else {
+        //The values are evaluated once, parameters would otherwise be cast for every row
+        out << "const auto key" << suffix << " = " << key.str() << ";" << endl;
+        if (!access.range.upper.empty()) {
+            out << "const " << Schema::type(*access.columns[bounded], 1) << " upper" << suffix << " = " << access.range.upper << ";" << endl;
+        }
+        out << "for (auto " << it << " = " << index << ".lower_bound(key" << suffix << "); " << it << " != " << index << ".end()";
+        for (size_t i = 0; i < access.values.size(); i++) {
+            out << " && std::get<" << i << ">(" << it << "->first) == std::get<" << i << ">(key" << suffix << ")";
+        }
+        //Behind the upper bound only keys with other leading values follow
+        if (!access.range.upper.empty()) {
+            out << " && std::get<" << bounded << ">(" << it << "->first) " << (access.range.upperExclusive ? "<" : "<=") << " upper" << suffix;
+        }
+        out << "; ++" << it << ") {" << endl;
+    }
+    out << "auto& r = db->" << table << ".table[" << it << "->second];" << endl;
+    out << body;
+    out << "}" << endl;
+    if (access.listing()) {
+        out << "}" << endl;
+    }
+    out << "} //End index lookup: " << table << endl;
+    return out.str();
+}
+
+IndexScan::Access IndexScan::findIndex(Schema::Relation& relation, const map<string, string>& values, const set<string>& joinColumns,
+                                       const map<string, Range>& ranges, const map<string, vector<string>>& lists) {
+    Access best;
+    if (relation.primaryKey.empty()) {
+        return best;
+    }
+
+    //Number of leading columns that have a value, a scan takes the values of one of them from its IN list
+    auto listed = [&](const string& column) {
+        return joinColumns.empty() && !values.count(column) && lists.count(column);
+    };
+    auto known = [&](const vector<unsigned>& keys) {
+        size_t count = 0, listCount = 0;
+        while (count < keys.size() && (values.count(relation.attributes[keys[count]].name) ||
+                                       (listCount == 0 && listed(relation.attributes[keys[count]].name)))) {
+            listCount += listed(relation.attributes[keys[count]].name);
+            count++;
+        }
+        for (auto& column : joinColumns) {
+            auto position = find_if(keys.begin(), keys.begin() + count, [&](unsigned key) { return relation.attributes[key].name == column; });
+            if (position == keys.begin() + count) {
+                return size_t(0);
+            }
+        }
+        return count;
+    };
+    auto use = [&](const string& index, const vector<unsigned>& keys, size_t count, bool ranged) {
+        best = Access();
+        best.index = index;
+        for (size_t i = 0; i < keys.size(); i++) {
+            best.columns.push_back(&relation.attributes[keys[i]]);
+            const string& column = relation.attributes[keys[i]].name;
+            if (i < count && listed(column)) {
+                best.values.push_back("");
+                best.list = lists.at(column);
+                best.listed = i;
+            } else if (i < count) {
+                best.values.push_back(values.at(column));
+            }
+        }
+        if (ranged) {
+            best.range = ranges.at(relation.attributes[keys[count]].name);
+        }
+    };
+
+    if (!relation.systemVersioning && known(relation.primaryKey) == relation.primaryKey.size()) {
+        use("pk", relation.primaryKey, relation.primaryKey.size(), false);
+        return best;
+    }
+
+    //A join probes once per outer tuple, so its prefix has to leave at most the last column open,
+    //like the orderlines of an order. A scan prefers more known columns, then a range on the next one.
+    size_t bestScore = 0;
+    auto consider = [&](const string& index, const vector<unsigned>& keys) {
+        const size_t count = known(keys);
+        const bool ranged = joinColumns.empty() && count < keys.size() && ranges.count(relation.attributes[keys[count]].name);
+        const size_t score = 2 * count + ranged;
+        if (score > bestScore && (joinColumns.empty() || count + 1 >= keys.size())) {
+            use(index, keys, count, ranged);
+            bestScore = score;
+        }
+    };
+
+    //Temporal tables keep every version of a key in the table, pkHistory finds all of them.
+    //The selection above decides which version is visible.
+    if (relation.systemVersioning) {
+        consider("pkHistory", relation.primaryKey);
+        return best;
+    }
+    consider("pkTree", relation.primaryKey);
+    for (auto& index : relation.indexes) {
+        consider(index.name, index.keys);
+    }
+    return best;
+}
+
+/// The expression of the value of a selection in the type of its column
+static string selectionValue(const pair<IU*, Predicate>& s) {
+    return Operator::value(*s.first->attr, s.second.value, s.second.param);
+}
+
+map<string, string> IndexScan::selectionValues(const selectionType& selections) {
+    map<string, string> values;
+    for (auto& s : selections) {
+        if (s.second.op != CompareOp::Equal || values.count(s.first->attr->name)) {
+            continue;
+        }
+        values[s.first->attr->name] = selectionValue(s);
+    }
+    return values;
+}
+
+map<string, IndexScan::Range> IndexScan::selectionRanges(const selectionType& selections) {
+    map<string, Range> ranges;
+    for (auto& s : selections) {
+        const CompareOp op = s.second.op;
+        if (!isRange(op)) {
+            continue;
+        }
+        //A lower bound that is not included only lets through the rows with the bound, the selection drops them
+        auto& range = ranges[s.first->attr->name];
+        if ((op == CompareOp::Greater || op == CompareOp::GreaterEqual) && range.lower.empty()) {
+            range.lower = selectionValue(s);
+        } else if ((op == CompareOp::Less || op == CompareOp::LessEqual) && range.upper.empty()) {
+            range.upper = selectionValue(s);
+            range.upperExclusive = op == CompareOp::Less;
+        }
+    }
+    return ranges;
+}
+
+map<string, vector<string>> IndexScan::selectionLists(const selectionType& selections) {
+    map<string, vector<string>> lists;
+    for (auto& s : selections) {
+        if (s.second.op != CompareOp::In || lists.count(s.first->attr->name)) {
+            continue;
+        }
+        auto& list = lists[s.first->attr->name];
+        for (size_t i = 0; i < s.second.values.size(); i++) {
+            list.push_back(Operator::value(*s.first->attr, s.second.values[i], s.second.params[i]));
+        }
+    }
+    return lists;
+}
@@ -0,0 +1,89 @@
+#ifndef TASK4_INDEXSCAN_H
+#define TASK4_INDEXSCAN_H
+
+
+#include <map>
+#include "Operator.h"
+#include "TableScan.h"
+#include "../query/Query.h"
+
+using namespace std;
+
+/// Scan that only visits the rows of a table whose key matches constant or parameter equality selections,
+/// by looking them up in the primary key or an ordered index instead of scanning the whole table. A range selection
+/// on the column after the known ones limits the rows further, they are visited in the order of the index.
+/// One of the known columns may be given by an IN list, then the index is probed once for every value of it.
+class IndexScan : public Operator {
+    friend class Interpreter;
+
+public:
+    /// Bounds of a column from its range selections, as expressions of the column type, empty if unbounded
+    struct Range {
+        string lower;
+        string upper;
+        /// The upper bound itself is not in the range
+        bool upperExclusive = false;
+    };
+
+    /// Which index to probe with which values
+    struct Access {
+        /// Member of the table: pk, pkTree, pkHistory or a secondary index
+        string index;
+        /// Columns of the index key
+        vector<Schema::Relation::Attribute*> columns;
+        /// Expressions for the leading columns of the key, the rest is a range
+        vector<string> values;
+        /// Bounds of the column after the values, the lower bound may let through rows the selection above drops
+        Range range;
+        /// Expressions of the values of an IN list for the column at listed, its entry in values is empty
+        vector<string> list;
+        size_t listed = 0;
+
+        bool valid() const { return !index.empty(); }
+
+        /// All columns are given and the index is unique
+        bool point() const { return index == "pk"; }
+
+        /// The column after the values is bounded
+        bool ranged() const { return !range.lower.empty() || !range.upper.empty(); }
+
+        /// One of the values is an IN list
+        bool listing() const { return !list.empty(); }
+    };
+
+private:
+    shared_ptr<TableScan> scan;
+    Access access;
+
+public:
+    /// Produces the IUs of the scan, the selection on top still checks all conditions
+    IndexScan(shared_ptr<TableScan> scan, const Access& access);
+
+    string produce() override;
+
+    string consume(Operator&) override;
+
+    string describe() const override;
+
+    /// Loop over the rows of the table matching the access, body is executed with the row bound to r
+    static string lookup(const string& table, const Access& access, const string& body);
+
+    /// Find the best index of the relation given the values known for some of its columns, invalid if none fits.
+    /// For joins the key has to include all joinColumns and may leave at most its last column open,
+    /// a scan can use any prefix and the ranges of the column after it. A scan may also take one column of its
+    /// prefix from the IN lists.
+    static Access findIndex(Schema::Relation& relation, const map<string, string>& values, const set<string>& joinColumns = {},
+                            const map<string, Range>& ranges = {}, const map<string, vector<string>>& lists = {});
+
+    /// Values of the equality selections, as expressions of the column type
+    static map<string, string> selectionValues(const selectionType& selections);
+
+    /// Bounds of the range selections, the first lower and upper bound of every column
+    static map<string, Range> selectionRanges(const selectionType& selections);
+
+    /// Values of the IN selections, as expressions of the column type
+    static map<string, vector<string>> selectionLists(const selectionType& selections);
+};
+
+
+#endif //TASK4_INDEXSCAN_H
@@ -2,6 +2,10 @@
 
 #include "Operator.h"
 #include "../parser/IU.h"
+#include "../parser/ParserError.h"
+
+map<int, string> Operator::parameters;
+string Operator::prologue;
 
 
 set<IU*>& Operator::getProduced() {
@@ -20,6 +24,83 @@ void Operator::setConsumer(Operator* op) {
     this->consumer = op;
 }
 
+bool Operator::pushFilter(const string&, const set<IU*>&) {
+    return false;
+}
+
+bool Operator::producesAll(const set<IU*>& ius) {
+    return includes(produced.begin(), produced.end(), ius.begin(), ius.end());
+}
+
+vector<Operator*> Operator::inputs() {
+    return {};
+}
+
+void Operator::analyze(vector<pair<string, unsigned>>& plan, unsigned depth) {
+    profileSlot = (int) plan.size();
+    plan.emplace_back(describe(), depth);
+    for (auto input : inputs()) {
+        input->analyze(plan, depth + 1);
+    }
+}
+
+string Operator::countTuple() const {
+    return profileSlot < 0 ? "" : "profile.tuples[" + to_string(profileSlot) + "]++;\n";
+}
+
+string Operator::countProbe() const {
+    return profileSlot < 0 ? "" : "profile.probes[" + to_string(profileSlot) + "]++;\n";
+}
+
+string Operator::passOn() {
+    return countTuple() + consumer->consume(*this);
+}
+
+string Operator::timed(const string& code) const {
+    if (profileSlot < 0) {
+        return code;
+    }
+    const string start = "start" + randomEntityName();
+    return "const uint64_t " + start + " = QueryProfile::now();\n" + code +
+           "profile.cycles[" + to_string(profileSlot) + "] += QueryProfile::now() - " + start + ";\n";
+}
+
+string Operator::parameter(int index, const string& type) {
+    auto it = parameters.emplace(index, type).first;
+    if (it->second != type) {
+        throw ParserError(0, "Parameter " + to_string(index + 1) + " is used as " + it->second + " and as " + type);
+    }
+    return "params.p" + to_string(index);
+}
+
+string Operator::value(const Schema::Relation::Attribute& attr, const string& value, int param) {
+    const string type = Schema::type(attr, 1);
+    if (value == "?") {
+        return parameter(param, type);
+    }
+    return type + "::castString(" + literal(value) + ", " + to_string(value.size()) + ")";
+}
+
+string Operator::literal(const string& value) {
+    string out = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"':
+            case '\\':
+            case '?': //No trigraphs
+                out += '\\';
+                out += c;
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+        }
+    }
+    return out + "\"";
+}
+
 string Operator::randomEntityName(std::string::size_type length) {
     static auto& chrs = "0123456789"
             "abcdefghijklmnopqrstuvwxyz"
@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <set>
+#include <map>
 #include <sstream>
 #include <algorithm>
 #include <random>
@@ -27,13 +28,61 @@ public:
 
     set<IU*>& getRequired();
 
+    bool producesAll(const set<IU*>& ius);
+
     string toString();
 
     void setConsumer(Operator*);
 
+    /// Evaluate a condition on the given IUs in the operator below that produces them, before the conditions of
+    /// the operators in between. Returns false if no operator can take it, then the caller has to check it itself.
+    virtual bool pushFilter(const string& condition, const set<IU*>& ius);
+
     static string randomEntityName(std::string::size_type len = 5);
 
+    /// Code reading a parameter of the query in the type it is compared with or assigned to, like Integer or Pattern
+    /// for a LIKE pattern. The parameter is added to the typed parameters of the query, it has only one type.
+    static string parameter(int index, const string& type);
+
+    /// Types of the parameters read by the code generated since they were cleared, by their index
+    static map<int, string> parameters;
+
+    /// Code run once per execution before the plan, cleared with the parameters. Operators declare what they build
+    /// from the parameters here, like the set of an IN list, as not every operator produces its own pipeline.
+    static string prologue;
+
+    /// A string as a C++ string literal in the generated code, with quotes and backslashes escaped
+    static string literal(const string& value);
+
+    /// Code of a constant or a parameter in the type of the column
+    static string value(const Schema::Relation::Attribute& attr, const string& value, int param);
+
+    /// Instrument the plan below for EXPLAIN ANALYZE: number the operators in pre-order and add the description of
+    /// every operator with its depth to plan. Their code then counts into the QueryProfile named profile.
+    void analyze(vector<pair<string, unsigned>>& plan, unsigned depth = 0);
+
+    /// Short description of the operator in the plan of EXPLAIN ANALYZE
+    virtual string describe() const = 0;
+
+    /// Code counting a tuple passed on by the operator, empty if it is not analyzed
+    string countTuple() const;
+
 protected:
+    /// Slot of the operator in the profile of EXPLAIN ANALYZE, -1 if it is not analyzed
+    int profileSlot = -1;
+
+    /// Operators below, in the order they are produced
+    virtual vector<Operator*> inputs();
+
+    /// Code passing the current tuple on to the consumer
+    string passOn();
+
+    /// Code counting a lookup in a hash table or index, empty if the operator is not analyzed
+    string countProbe() const;
+
+    /// Measure the cycles of the code of a pipeline or another piece of work the operator starts
+    string timed(const string& code) const;
+
     Operator* consumer;
     set<IU*> produced{};
     set<IU*> required{};
@@ -76,3 +76,10 @@ string Print::consume(Operator& op) {
     return out.str();
 }
 
+string Print::describe() const {
+    return "Print";
+}
+
+vector<Operator*> Print::inputs() {
+    return {&input};
+}
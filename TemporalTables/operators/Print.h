@@ -6,6 +6,8 @@
 #include "HashJoin.h"
 
 class Print : Operator {
+    friend class Interpreter;
+
     Operator& input;
     vector<IU*>& outVars;
 public:
@@ -14,7 +16,15 @@ public:
     string produce() override;
 
     string consume(Operator&) override;
+
+    string describe() const override;
+
+protected:
+    vector<Operator*> inputs() override;
 };
 
+/// Width of the column of an attribute in the output
+int getColumnWidth(Schema::Relation::Attribute* a);
+
 
 #endif //TASK4_PRINT_H
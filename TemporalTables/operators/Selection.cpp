@@ -2,8 +2,8 @@
 #include <tuple>
 #include "Selection.h"
 
-Selection::Selection(shared_ptr<Operator> in, selectionType cond, Timestamp sysTimeStart, Timestamp sysTimeEnd, int paramOffset)
-        : input(in), conditions(cond), sysTimeStart(sysTimeStart), sysTimeEnd(sysTimeEnd), paramOffset(paramOffset) {
+Selection::Selection(shared_ptr<Operator> in, selectionType cond, Timestamp sysTimeStart, Timestamp sysTimeEnd)
+        : input(in), conditions(cond), sysTimeStart(sysTimeStart), sysTimeEnd(sysTimeEnd) {
     input->setConsumer(this);
     for (auto& c : conditions) {
         this->required.insert(c.first);
@@ -36,6 +36,8 @@ string Selection::produce() {
 string Selection::consume(Operator& op) {
     stringstream out;
     //out << "cout << " << sysTimeStartIU->attr->name << ".value << \" \" << " << sysTimeEndIU->attr->name << ".value << endl;" << endl;
+    //Conditions that are left after pushing one down to the scan
+    const size_t remaining = conditions.size() - (pushedCondition == -1 ? 0 : 1) + pushedFilters.size();
     out << "if(";
     if (sysTimeStartIU != nullptr && sysTimeEndIU != nullptr) {
         out << "(";
@@ -63,33 +65,128 @@ string Selection::consume(Operator& op) {
         }
         out << ")";
 
-        if (conditions.size() > 0) {
+        if (remaining > 0) {
             out << "&&";
         }
+    } else if (remaining == 0) {
+        out << "true";
     }
 
+    vector<string> terms(pushedFilters);
+    for (size_t i = 0; i < conditions.size(); i++) {
+        auto& c = conditions[i];
+        stringstream term;
+        if ((int) i == pushedCondition) {
+            continue;
+        }
 
-    for (auto& c : conditions) {
-        out << c.first->attr->name << " == ";
-        if (c.second == "?") {
-            out << c.first->attr->name << ".castString(";
-            out << "params[" << paramOffset << "].c_str(), " << "params[" << paramOffset << "].size())";
-            paramOffset++;
-        } else if (c.first->attr->type == Types::Tag::Integer) {
-            out << c.second;
+        if (c.second.op == CompareOp::Like) {
+            term << "likeMatch(" << c.first->attr->name << ".begin(), " << c.first->attr->name << ".length(), ";
+            if (c.second.value == "?") {
+                const string pattern = parameter(c.second.param, "Pattern");
+                term << pattern << ".begin(), " << pattern << ".length())";
+            } else {
+                term << literal(c.second.value) << ", " << c.second.value.size() << ")";
+            }
+        } else if (c.second.op == CompareOp::In) {
+            term << inList(*c.first->attr, c.second);
         } else {
-            out << c.first->attr->name << ".castString(";
-            out << "\"" << c.second << "\", " << c.second.size() << ")";
+            term << c.first->attr->name << " " << compareOperator(c.second.op) << " ";
+            if (c.second.value == "?") {
+                term << parameter(c.second.param, Schema::type(*c.first->attr, true));
+            } else if (c.first->attr->type == Types::Tag::Integer) {
+                term << c.second.value;
+            } else {
+                term << c.first->attr->name << ".castString(";
+                term << literal(c.second.value) << ", " << c.second.value.size() << ")";
+            }
         }
-        if (c != *(conditions.end() - 1)) {
+        terms.push_back(term.str());
+    }
+    for (auto& term : terms) {
+        out << term;
+        if (&term != &terms.back()) {
             out << " && ";
         }
     }
     out << ") { " << endl;
-    out << consumer->consume(*this);
+    out << passOn();
     out << "}" << endl;
     return out.str();
 }
 
+string Selection::inList(const Schema::Relation::Attribute& attr, const Predicate& predicate) {
+    vector<string> values;
+    for (size_t i = 0; i < predicate.values.size(); i++) {
+        values.push_back(Operator::value(attr, predicate.values[i], predicate.params[i]));
+    }
+
+    //A short list is compared with every value without branches, a longer one is looked up in a hash set that is
+    //built once per execution
+    stringstream out;
+    if (values.size() <= smallList) {
+        out << "(";
+        for (auto& value : values) {
+            out << (&value != &values.front() ? " | " : "") << "(" << attr.name << " == " << value << ")";
+        }
+        out << ")";
+        return out.str();
+    }
+    const string set = "in" + randomEntityName();
+    stringstream declaration;
+    declaration << "const ValueSet<" << Schema::type(attr, true) << "> " << set << "{";
+    for (auto& value : values) {
+        declaration << (&value != &values.front() ? ", " : "") << value;
+    }
+    declaration << "};" << endl;
+    prologue += declaration.str();
+    out << set << ".contains(" << attr.name << ")";
+    return out.str();
+}
+
+string Selection::describe() const {
+    stringstream out;
+    out << "Selection";
+    for (size_t i = 0; i < conditions.size(); i++) {
+        if ((int) i != pushedCondition) {
+            out << " " << conditions[i].first->attr->name << conditions[i].second;
+        }
+    }
+    if (sysTimeStartIU != nullptr && sysTimeEndIU != nullptr) {
+        out << " (system time)";
+    }
+    if (!pushedFilters.empty()) {
+        out << " (" << pushedFilters.size() << " join filter" << (pushedFilters.size() > 1 ? "s" : "") << ")";
+    }
+    return out.str();
+}
+
+vector<Operator*> Selection::inputs() {
+    return {input.get()};
+}
+
+void Selection::pushDownFilter() {
+    auto scan = dynamic_cast<TableScan*>(input.get());
+    if (scan == nullptr) {
+        return;
+    }
 
+    for (size_t i = 0; i < conditions.size(); i++) {
+        if (TableScan::canFilter(conditions[i].first, conditions[i].second)) {
+            scan->setFilter(conditions[i].first, conditions[i].second);
+            pushedCondition = (int) i;
+            return;
+        }
+    }
+}
 
+bool Selection::pushFilter(const string& condition, const set<IU*>& ius) {
+    if (input->pushFilter(condition, ius)) {
+        return true;
+    }
+    if (!producesAll(ius)) {
+        return false;
+    }
+    pushedFilters.push_back(condition);
+    return true;
+}
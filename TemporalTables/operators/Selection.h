@@ -9,6 +9,8 @@
 #include "../parser/IU.h"
 
 class Selection : public Operator {
+    friend class Interpreter;
+
     shared_ptr<Operator> input;
     selectionType conditions;
 
@@ -17,15 +19,34 @@ class Selection : public Operator {
     Timestamp sysTimeEnd = Timestamp::null();
     IU* sysTimeEndIU = nullptr;
 
-    int paramOffset;
+    /// Index of the condition evaluated by the table scan, -1 if none
+    int pushedCondition = -1;
+
+    /// Conditions of the operators above that the input could not take, checked before the own conditions
+    vector<string> pushedFilters;
+
+    /// Longest IN list that is compared with every value instead of being looked up in a ValueSet
+    static constexpr size_t smallList = 8;
+
+    /// Code of the condition of an IN list, declares the set of a long list in the prologue
+    static string inList(const Schema::Relation::Attribute& attr, const Predicate& predicate);
 
 public:
-    Selection(shared_ptr<Operator>, selectionType, Timestamp = Timestamp::null(), Timestamp = Timestamp::null(), int = 0);
+    Selection(shared_ptr<Operator>, selectionType, Timestamp = Timestamp::null(), Timestamp = Timestamp::null());
 
     string produce() override;
 
     string consume(Operator&) override;
 
+    /// Let the table scan below evaluate the first string condition in batches, only valid for read only queries
+    void pushDownFilter();
+
+    bool pushFilter(const string& condition, const set<IU*>& ius) override;
+
+    string describe() const override;
+
+protected:
+    vector<Operator*> inputs() override;
 };
 
 
@@ -0,0 +1,131 @@
+#include <sstream>
+#include "Sort.h"
+#include "../parser/IU.h"
+
+using namespace std;
+
+Sort::Sort(Operator& input, const vector<Key>& keys, long limit)
+        : input(input), keys(keys), limit(limit), suffix(Operator::randomEntityName()) {
+    input.setConsumer(this);
+    for (auto& key : keys) {
+        this->required.insert(key.first);
+    }
+    this->produced.insert(input.getProduced().begin(), input.getProduced().end());
+}
+
+string Sort::tupleType() const {
+    stringstream out;
+    out << "std::tuple<";
+    for (auto iu : columns) {
+        out << Schema::type(*iu->attr, 1) << (iu != columns.back() ? ", " : "");
+    }
+    out << ">";
+    return out.str();
+}
+
+string Sort::produce() {
+    this->required.insert(consumer->getRequired().begin(), consumer->getRequired().end());
+    const string rows = "rows" + suffix, less = "less" + suffix, i = "i" + suffix;
+
+    stringstream out;
+    if (keys.empty()) {
+        //Only a limit, the tuples are passed on directly
+        out << "long count" << suffix << " = 0;" << endl;
+        out << input.produce();
+        return out.str();
+    }
+
+    columns.assign(this->required.begin(), this->required.end());
+    out << "std::vector<" << tupleType() << "> " << rows << ";" << endl;
+    if (topK()) {
+        out << rows << ".reserve(" << limit << ");" << endl;
+    }
+
+    //Compare the keys in order, only operator< is needed from the types
+    out << "auto " << less << " = [](const " << tupleType() << "& a, const " << tupleType() << "& b) {" << endl;
+    for (auto& key : keys) {
+        const size_t index = find(columns.begin(), columns.end(), key.first) - columns.begin();
+        string a = "std::get<" + to_string(index) + ">(a)", b = "std::get<" + to_string(index) + ">(b)";
+        if (key.second) {
+            swap(a, b);
+        }
+        out << "if (" << a << " < " << b << ") { return true; }" << endl;
+        out << "if (" << b << " < " << a << ") { return false; }" << endl;
+    }
+    out << "return false;" << endl;
+    out << "};" << endl;
+
+    out << input.produce();
+    stringstream output;
+    if (topK()) {
+        output << "std::sort_heap(" << rows << ".begin(), " << rows << ".end(), " << less << ");" << endl;
+    } else {
+        //Sequential below a few thousand tuples, see __gnu_parallel::_Settings::sort_minimal_n
+        output << "__gnu_parallel::sort(" << rows << ".begin(), " << rows << ".end(), " << less << ", __gnu_parallel::multiway_mergesort_tag());" << endl;
+    }
+
+    output << "for (size_t " << i << " = 0; " << i << " < ";
+    output << (limit >= 0 ? "std::min<size_t>(" + to_string(limit) + ", " + rows + ".size())" : rows + ".size()");
+    output << "; " << i << "++) { //Start sorted output" << endl;
+    for (size_t c = 0; c < columns.size(); c++) {
+        output << "const auto& " << columns[c]->attr->name << " = std::get<" << c << ">(" << rows << "[" << i << "]);" << endl;
+    }
+    output << passOn();
+    output << "} //End sorted output" << endl;
+    out << timed(output.str());
+    return out.str();
+}
+
+string Sort::consume(Operator&) {
+    const string rows = "rows" + suffix, less = "less" + suffix;
+    stringstream out;
+    if (keys.empty()) {
+        out << "if (count" << suffix << " < " << limit << ") {" << endl;
+        out << "count" << suffix << "++;" << endl;
+        out << passOn();
+        out << "}" << endl;
+        return out.str();
+    }
+
+    stringstream values;
+    for (auto iu : columns) {
+        values << iu->attr->name << (iu != columns.back() ? ", " : "");
+    }
+    if (!topK()) {
+        out << rows << ".emplace_back(" << values.str() << ");" << endl;
+        return out.str();
+    }
+    if (limit == 0) {
+        return "";
+    }
+
+    //The heap keeps the best tuples so far with the worst of them on top
+    out << "if (" << rows << ".size() < " << limit << ") {" << endl;
+    out << rows << ".emplace_back(" << values.str() << ");" << endl;
+    out << "std::push_heap(" << rows << ".begin(), " << rows << ".end(), " << less << ");" << endl;
+    out << "} else {" << endl;
+    out << tupleType() << " row" << suffix << "(" << values.str() << ");" << endl;
+    out << "if (" << less << "(row" << suffix << ", " << rows << ".front())) {" << endl;
+    out << "std::pop_heap(" << rows << ".begin(), " << rows << ".end(), " << less << ");" << endl;
+    out << rows << ".back() = row" << suffix << ";" << endl;
+    out << "std::push_heap(" << rows << ".begin(), " << rows << ".end(), " << less << ");" << endl;
+    out << "}" << endl;
+    out << "}" << endl;
+    return out.str();
+}
+
+string Sort::describe() const {
+    stringstream out;
+    out << (keys.empty() ? "Limit" : topK() ? "TopK" : "Sort");
+    for (auto& key : keys) {
+        out << (&key != &keys.front() ? ", " : " ") << key.first->attr->name << (key.second ? " DESC" : "");
+    }
+    if (limit >= 0) {
+        out << " LIMIT " << limit;
+    }
+    return out.str();
+}
+
+vector<Operator*> Sort::inputs() {
+    return {&input};
+}
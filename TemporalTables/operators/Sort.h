@@ -0,0 +1,47 @@
+#ifndef TASK4_SORT_H
+#define TASK4_SORT_H
+
+
+#include "Operator.h"
+
+using namespace std;
+
+/// Materializes the tuples with the IUs its consumer requires and passes them on sorted by the keys.
+/// With a small limit only the best tuples are kept in a heap (top k), larger inputs are sorted with the parallel
+/// merge sort of the GNU parallel mode. Without keys it only applies the limit and does not materialize.
+class Sort : public Operator {
+public:
+    /// A column to sort by, descending or ascending
+    using Key = pair<IU*, bool>;
+
+private:
+    Operator& input;
+    vector<Key> keys;
+    /// Number of tuples to output, -1 for all
+    long limit;
+    /// IUs stored for every tuple, in the order of the tuple
+    vector<IU*> columns;
+    string suffix;
+
+    /// Limits up to this use a heap instead of sorting the whole input
+    static const long topKLimit = 1024;
+
+    bool topK() const { return limit >= 0 && limit <= topKLimit; }
+
+    string tupleType() const;
+
+public:
+    Sort(Operator& input, const vector<Key>& keys, long limit);
+
+    string produce() override;
+
+    string consume(Operator&) override;
+
+    string describe() const override;
+
+protected:
+    vector<Operator*> inputs() override;
+};
+
+
+#endif //TASK4_SORT_H
@@ -19,14 +19,131 @@ TableScan::~TableScan() {
 
 string TableScan::produce() {
     stringstream out;
-    out << "for(auto& r: db->" << relation.name << ".table) { //Start for: " << relation.name << endl;
+    stringstream bindings;
     for (const auto e : consumer->getRequired()) {
         if (e->rel == this) {
-            out << "auto& " << e->attr->name << " = " << "r." << e->attr->name << ";" << endl;
+            bindings << "auto& " << e->attr->name << " = " << "r." << e->attr->name << ";" << endl;
         }
     }
-    out << consumer->consume(*this) << endl;
-    out << "} //End for: " << relation.name << endl;
+
+    if (filterIU == nullptr) {
+        out << "for(auto& r: db->" << relation.name << ".table) { //Start for: " << relation.name << endl;
+        out << bindings.str();
+        out << consumeRow() << endl;
+        out << "} //End for: " << relation.name << endl;
+        return timed(out.str());
+    }
+
+    //Filter a batch of rows into a selection vector, then only visit the qualifying rows
+    string suffix = Operator::randomEntityName();
+    string table = "table" + suffix, base = "base" + suffix, sel = "sel" + suffix, count = "count" + suffix;
+    out << "{ //Start batched scan: " << relation.name << " " << filterIU->attr->name << filter << endl;
+    out << "auto& " << table << " = db->" << relation.name << ".table;" << endl;
+    out << "uint32_t " << sel << "[" << batchSize << "];" << endl;
+    out << "for (size_t " << base << " = 0; " << base << " < " << table << ".size(); " << base << " += " << batchSize << ") {" << endl;
+    out << "const unsigned " << count << " = " << filterCall(table + "[" + base + "]." + filterIU->attr->name,
+                                                            "(unsigned) std::min<size_t>(" + to_string(batchSize) + ", " + table + ".size() - " + base + ")",
+                                                            sel) << ";" << endl;
+    out << "for (unsigned i" << suffix << " = 0; i" << suffix << " < " << count << "; i" << suffix << "++) {" << endl;
+    out << "auto& r = " << table << "[" << base << " + " << sel << "[i" << suffix << "]];" << endl;
+    out << bindings.str();
+    out << consumeRow() << endl;
+    out << "}" << endl;
+    out << "}" << endl;
+    out << "} //End batched scan: " << relation.name << endl;
+    return timed(out.str());
+}
+
+string TableScan::filterCall(const string& column, const string& count, const string& sel) const {
+    stringstream out;
+    string stride = "sizeof(db->" + relation.name + ".table[0])";
+    string args = "&" + column + ", " + stride + ", " + count + ", ";
+
+    if (filter.op == CompareOp::Equal) {
+        //Compare with the value as it would be stored in the column
+        const string type = Schema::type(*filterIU->attr, true);
+        out << "[&]() { const auto& value = ";
+        if (filter.value == "?") {
+            out << parameter(filter.param, type);
+        } else {
+            out << type << "::castString(" << literal(filter.value) << ", " << filter.value.size() << ")";
+        }
+        out << "; return selectEqual(" << args << "value.value, value.len, " << sel << "); }()";
+        return out.str();
+    }
+
+    if (filter.value == "?") {
+        const string pattern = parameter(filter.param, "Pattern");
+        out << "selectLike(" << args << pattern << ".begin(), " << pattern << ".length(), " << sel << ")";
+        return out.str();
+    }
+
+    //Choose the kernel for a constant pattern now, instead of for every batch
+    const string& pattern = filter.value;
+    const bool leading = pattern.size() > 0 && pattern.front() == '%';
+    const bool trailing = pattern.size() > (leading ? 1 : 0) && pattern.back() == '%';
+    const string x = pattern.substr(leading, pattern.size() - leading - trailing);
+    string kernel = "selectLike";
+    string argument = pattern;
+    if (x.find_first_of("%_") == string::npos) {
+        argument = x;
+        if (!leading && !trailing) {
+            kernel = "selectEqual";
+        } else if (!leading) {
+            kernel = "selectPrefix";
+        } else if (!trailing) {
+            kernel = "selectSuffix";
+        } else {
+            kernel = "selectContains";
+        }
+    }
+    out << kernel << "(" << args << literal(argument) << ", " << argument.size() << ", " << sel << ")";
+    return out.str();
+}
+
+bool TableScan::canFilter(IU* iu, const Predicate& predicate) {
+    const auto& attr = *iu->attr;
+    return (attr.type == Types::Tag::Varchar || (attr.type == Types::Tag::Char && attr.len1 > 1)) &&
+           (predicate.op == CompareOp::Equal || predicate.op == CompareOp::Like);
+}
+
+void TableScan::setFilter(IU* iu, const Predicate& predicate) {
+    filterIU = iu;
+    filter = predicate;
+}
+
+bool TableScan::pushFilter(const string& condition, const set<IU*>& ius) {
+    if (!producesAll(ius)) {
+        return false;
+    }
+    pushedFilters.push_back(condition);
+    return true;
+}
+
+string TableScan::consumeRow() {
+    if (pushedFilters.empty()) {
+        return passOn();
+    }
+    stringstream out;
+    out << "if (";
+    for (auto& condition : pushedFilters) {
+        out << condition << (&condition != &pushedFilters.back() ? " && " : "");
+    }
+    out << ") {" << endl;
+    out << passOn();
+    out << "}";
+    return out.str();
+}
+
+string TableScan::describe() const {
+    stringstream out;
+    out << "TableScan " << relation.name;
+    if (filterIU != nullptr) {
+        out << " " << filterIU->attr->name << filter;
+    }
+    if (!pushedFilters.empty()) {
+        out << " (" << pushedFilters.size() << " join filter" << (pushedFilters.size() > 1 ? "s" : "") << ")";
+    }
     return out.str();
 }
 
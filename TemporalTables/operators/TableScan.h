@@ -8,11 +8,27 @@
 
 #include "Operator.h"
 #include "../parser/Schema.hpp"
+#include "../query/Predicate.h"
 
 
 class TableScan: public Operator  {
     Schema::Relation& relation;
 
+    /// A string predicate that is evaluated in batches with the filter kernels of Types.hpp
+    IU* filterIU = nullptr;
+    Predicate filter;
+
+    /// Rows per batch of the selection vector
+    static const unsigned batchSize = 1024;
+
+    /// Conditions pushed down by the operators above, checked before a row is passed on
+    vector<string> pushedFilters;
+
+    string filterCall(const string& column, const string& count, const string& sel) const;
+
+    /// Pass the current row on, if it passes the pushed down conditions
+    string consumeRow();
+
 public:
     TableScan(Schema::Relation&);
     ~TableScan() override;
@@ -21,6 +37,18 @@ public:
     string consume(Operator&) override;
 
     IU* getIU(const string& name);
+
+    Schema::Relation& getRelation() { return relation; }
+
+    /// Check if the predicate can be evaluated by the filter kernels
+    static bool canFilter(IU* iu, const Predicate& predicate);
+
+    /// Evaluate the predicate while scanning
+    void setFilter(IU* iu, const Predicate& predicate);
+
+    bool pushFilter(const string& condition, const set<IU*>& ius) override;
+
+    string describe() const override;
 };
 
 
@@ -2,8 +2,8 @@
 #include "Update.h"
 
 
-Update::Update(Operator& input, vector<fieldType>& fields, Schema::Relation rel, selectionType selections, int paramOffset)
-        : input(input), outVars(fields), relation(rel), selections(selections), paramOffset(paramOffset) {
+Update::Update(Operator& input, vector<fieldType>& fields, Schema::Relation rel, selectionType selections)
+        : input(input), outVars(fields), relation(rel), selections(selections) {
     input.setConsumer(this);
     for (auto& e : outVars) {
         this->required.insert(e.first);
@@ -16,6 +16,9 @@ string Update::produce() {
     if (selections.size() == relation.primaryKey.size()) {
         bool canDoPK = true;
         for (auto& e : selections) {
+            if (e.second.op != CompareOp::Equal) {
+                canDoPK = false;
+            }
             bool found = false;
             for (auto& a : relation.primaryKey) {
                 if (e.first->attr->name == relation.attributes[a].name) {
@@ -38,12 +41,10 @@ string Update::produce() {
                 for (auto& selection : selections) {
                     if (selection.first->attr->name == relation.attributes[pkAttrKey].name) {
                         if (selection.first->attr->type == Types::Tag::Integer) {
-                            if (selection.second == "?") {
-                                keyTuple << Schema::type(*selection.first->attr, true) << "::castString(";
-                                keyTuple << "params[" << paramOffset << "].c_str(), " << "params[" << paramOffset << "].size())";
-                                paramOffset++;
+                            if (selection.second.value == "?") {
+                                keyTuple << parameter(selection.second.param, Schema::type(*selection.first->attr, true));
                             } else {
-                                keyTuple << selection.second;
+                                keyTuple << selection.second.value;
                             }
                         } else {
                             throw ParserError(0, "Type in key not supported in deletes");
@@ -64,15 +65,14 @@ string Update::produce() {
             out << "\tauto e = " << table << ".row(iter->second);" << endl;
             int currentVar = 0;
             for (auto& e: outVars) {
-                out << "e.";
-                out << e.first->attr->name << " = e." << e.first->attr->name << ".castString(";
+                out << "e." << e.first->attr->name << " = ";
                 if (e.second == "?") {
-                    out << "params[" << currentVar << "].c_str(), " << "params[" << currentVar << "].size()";
+                    out << parameter(currentVar, Schema::type(*e.first->attr, true));
                     currentVar++;
                 } else {
-                    out << "\"" << e.second << "\", " << e.second.size();
+                    out << "e." << e.first->attr->name << ".castString(" << literal(e.second) << ", " << e.second.size() << ")";
                 }
-                out << ");";
+                out << ";";
 
             }
             out << "\t" << table << ".update(e);" << endl;
@@ -94,18 +94,24 @@ string Update::consume(Operator& op) {
     out << "auto e = r;" << endl;
     int currentVar = 0;
     for (auto& e: outVars) {
-        out << "e.";
-        out << e.first->attr->name << " = e." << e.first->attr->name << ".castString(";
+        out << "e." << e.first->attr->name << " = ";
         if (e.second == "?") {
-            out << "params[" << currentVar << "].c_str(), " << "params[" << currentVar << "].size()";
+            out << parameter(currentVar, Schema::type(*e.first->attr, true));
             currentVar++;
         } else {
-            out << "\"" << e.second << "\", " << e.second.size();
+            out << "e." << e.first->attr->name << ".castString(" << literal(e.second) << ", " << e.second.size() << ")";
         }
-        out << ");";
+        out << ";";
 
     }
     out << "db->" << relation.name << ".update(e);" << endl;
     return out.str();
 }
 
+string Update::describe() const {
+    return "Update " + relation.name;
+}
+
+vector<Operator*> Update::inputs() {
+    return {&input};
+}
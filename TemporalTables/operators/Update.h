@@ -11,19 +11,25 @@
 using fieldType = pair<IU*, string>;
 
 class Update : Operator {
+    friend class Interpreter;
+
     Operator& input;
     vector<fieldType>& outVars;
     Schema::Relation relation;
     selectionType selections;
-    int paramOffset;
 
 public:
-    Update(Operator&, vector<fieldType>&, Schema::Relation, selectionType selections, int = 0);
+    Update(Operator&, vector<fieldType>&, Schema::Relation, selectionType selections);
 
     string produce() override;
 
     string consume(Operator&) override;
 
+    string describe() const override;
+
+protected:
+    vector<Operator*> inputs() override;
+
 };
 
 
@@ -1,6 +1,7 @@
 #include <string>
 #include <iostream>
 #include <cctype>
+#include <algorithm>
 #include "SQLLexer.hpp"
 
 using namespace std;
@@ -39,7 +40,23 @@ SQLLexer::Token SQLLexer::getNext(){
 			case ')': return ParClose;
 			case '?': return Questionmark;
 			case '<':
-				if ((pos==input.end())||((*pos)!='>'))
+				if ((pos!=input.end())&&((*pos)=='>')) {
+					++pos;
+					return NotEqual;
+				}
+				if ((pos!=input.end())&&((*pos)=='=')) {
+					++pos;
+					return LessEqual;
+				}
+				return Less;
+			case '>':
+				if ((pos!=input.end())&&((*pos)=='=')) {
+					++pos;
+					return GreaterEqual;
+				}
+				return Greater;
+			case '!':
+				if ((pos==input.end())||((*pos)!='='))
 					return Error;
 				++pos;
 				return NotEqual;
@@ -114,6 +131,15 @@ bool SQLLexer::isKeyword(const char* keyword) const{
 	return !(*keyword);
 }
 
+bool SQLLexer::hasParameters() const{
+	SQLLexer scan(input);
+	for (Token token = scan.getNext(); token != Eof && token != Error; token = scan.getNext()) {
+		if (token == Questionmark)
+			return true;
+	}
+	return false;
+}
+
 void SQLLexer::unget(Token value){
 	putBack = value;
 }
@@ -129,3 +155,18 @@ string::const_iterator SQLLexer::getReader() const {
 		return tokenStart;
 	return pos;
 }
+
+const string& SQLLexer::getInput() const {
+	return input;
+}
+
+pair<size_t, size_t> SQLLexer::getTokenRange() const {
+	size_t begin = tokenStart - input.begin();
+	size_t end = (hasTokenEnd ? tokenEnd : pos) - input.begin();
+	if (hasTokenEnd) {
+		//Include the quotes around a string constant
+		begin--;
+		end = min(end + 1, input.size());
+	}
+	return make_pair(begin, end);
+}
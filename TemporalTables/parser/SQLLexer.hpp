@@ -2,6 +2,7 @@
 #define SQLLexer_HPP
 
 #include <string>
+#include <utility>
 
 
 class SQLLexer {
@@ -24,7 +25,11 @@ public:
         Minus,      //14
         ParOpen,    //15
         ParClose,    //16
-        Questionmark    //17
+        Questionmark,    //17
+        Less,       //18
+        LessEqual,  //19
+        Greater,    //20
+        GreaterEqual    //21
     };
 private:
     // input string
@@ -62,6 +67,15 @@ public:
 
     // get the reader position
     std::string::const_iterator getReader() const;
+
+    // get the input
+    const std::string& getInput() const;
+
+    // check if the input has a question mark outside of string constants, a parameter numbered by the caller
+    bool hasParameters() const;
+
+    // get the offsets of the first and behind the last character of the current token, a string with its quotes
+    std::pair<size_t, size_t> getTokenRange() const;
 };
 
 #endif
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "SQLParser.hpp"
 #include "../query/Update.h"
 
@@ -6,7 +7,32 @@ using namespace std;
 SQLParser::ParserException::ParserException(const std::string& msg) : runtime_error(msg) {
 }
 
-SQLParser::SQLParser(SQLLexer& lexer) : lexer(lexer) {
+SQLParser::SQLParser(SQLLexer& lexer, bool parameterize) : lexer(lexer), parameterize(parameterize) {
+}
+
+int SQLParser::parameterizeConstant() {
+    return parameterizeConstant(lexer.getTokenValue(), lexer.getTokenRange());
+}
+
+int SQLParser::parameterizeConstant(const string& value, pair<size_t, size_t> range) {
+    if (!parameterize) {
+        return -1;
+    }
+    constants.push_back(value);
+    constantRanges.push_back(range);
+    return parameters++;
+}
+
+const vector<string>& SQLParser::getConstants() const {
+    return constants;
+}
+
+string SQLParser::getNormalizedQuery() const {
+    string query = lexer.getInput();
+    for (auto range = constantRanges.rbegin(); range != constantRanges.rend(); ++range) {
+        query.replace(range->first, range->second - range->first, "?");
+    }
+    return query;
 }
 
 SQLParser::~SQLParser() {
@@ -26,7 +52,15 @@ void SQLParser::parseSelect(QuerySelect* query) {
                 }
                 break;
             }
-            query->projection.push_back(lexer.getTokenValue());
+            //A column or an aggregate function
+            string name = lexer.getTokenValue();
+            token = lexer.getNext();
+            if (token == SQLLexer::ParOpen) {
+                parseAggregate(query, name);
+            } else {
+                lexer.unget(token);
+                query->projection.push_back(name);
+            }
         } else if (token == SQLLexer::Star) {
             query->projectAll = true;
         } else if (token == SQLLexer::Comma) {
@@ -44,6 +78,89 @@ void SQLParser::parseSelect(QuerySelect* query) {
     }
 }
 
+void SQLParser::parseAggregate(QuerySelect* query, const string& function) {
+    AggregateItem item;
+    string name = function;
+    transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name == "count") {
+        item.op = AggregateOp::Count;
+    } else if (name == "sum") {
+        item.op = AggregateOp::Sum;
+    } else if (name == "min") {
+        item.op = AggregateOp::Min;
+    } else if (name == "max") {
+        item.op = AggregateOp::Max;
+    } else if (name == "avg") {
+        item.op = AggregateOp::Avg;
+    } else {
+        throw ParserException("Unknown aggregate function: " + function);
+    }
+
+    //Keep the tokens of the argument, the aggregate operator compiles them once the types are known
+    int depth = 0;
+    while (true) {
+        SQLLexer::Token token = lexer.getNext();
+        if (token == SQLLexer::ParClose && depth == 0) {
+            break;
+        }
+        if (token == SQLLexer::Identifier) {
+            item.argument.push_back(lexer.getTokenValue());
+        } else if (token == SQLLexer::Integer) {
+            //Decimal constants are lexed as integer, dot and integer
+            string value = lexer.getTokenValue();
+            token = lexer.getNext();
+            if (token == SQLLexer::Dot) {
+                if (lexer.getNext() != SQLLexer::Integer) {
+                    throw ParserException("Expected digits after '.' in aggregate");
+                }
+                value += "." + lexer.getTokenValue();
+            } else {
+                lexer.unget(token);
+            }
+            item.argument.push_back(value);
+        } else if (token == SQLLexer::Star) {
+            item.argument.push_back("*");
+        } else if (token == SQLLexer::Plus) {
+            item.argument.push_back("+");
+        } else if (token == SQLLexer::Minus) {
+            item.argument.push_back("-");
+        } else if (token == SQLLexer::ParOpen) {
+            item.argument.push_back("(");
+            depth++;
+        } else if (token == SQLLexer::ParClose) {
+            item.argument.push_back(")");
+            depth--;
+        } else {
+            throw ParserException("Unexpected token in aggregate: " + lexer.getTokenValue());
+        }
+    }
+
+    if (item.op == AggregateOp::Count && item.argument.size() == 1 && item.argument[0] == "*") {
+        item.argument.clear();
+    } else if (item.argument.empty()) {
+        throw ParserException("Missing argument of " + function);
+    }
+
+    //Name the output column
+    SQLLexer::Token token = lexer.getNext();
+    if (token == SQLLexer::Identifier && lexer.isKeyword("as")) {
+        if (lexer.getNext() != SQLLexer::Identifier) {
+            throw ParserException("Expected name after 'AS'");
+        }
+        item.name = lexer.getTokenValue();
+    } else {
+        lexer.unget(token);
+        if (item.argument.empty()) {
+            item.name = name;
+        } else if (item.argument.size() == 1) {
+            item.name = name + "_" + item.argument[0];
+        } else {
+            item.name = name + "_" + to_string(query->aggregates.size() + 1);
+        }
+    }
+    query->aggregates.push_back(item);
+}
+
 void SQLParser::parseFrom(QuerySelect* query) {
     SQLLexer::Token token = lexer.getNext();
     if (token != SQLLexer::Identifier || !lexer.isKeyword("from")) {
@@ -53,7 +170,9 @@ void SQLParser::parseFrom(QuerySelect* query) {
     bool isRelationParsed = false;
     while (true) {
         token = lexer.getNext();
-        if (lexer.isKeyword("where") || lexer.isKeyword("for")) {
+        //order is also a table name, it only starts a clause after a relation
+        if (lexer.isKeyword("where") || lexer.isKeyword("for") ||
+            (isRelationParsed && (lexer.isKeyword("group") || lexer.isKeyword("order") || lexer.isKeyword("limit")))) {
             lexer.unget(token);
             break;
         }
@@ -124,7 +243,59 @@ void SQLParser::parseFor(QuerySelect* query) {
     }
 }
 
-/// Warning: only handles expressions of a form attr1=attr2, or attr = constant
+int SQLParser::parseConstant(SQLLexer::Token token, bool keep, string& constant) {
+    if (token == SQLLexer::Questionmark) {
+        constant = "?";
+        return parameters++;
+    }
+    constant = lexer.getTokenValue();
+    auto range = lexer.getTokenRange();
+    if (token == SQLLexer::Integer) {
+        //Decimal constants are lexed as integer, dot and integer
+        token = lexer.getNext();
+        if (token == SQLLexer::Dot) {
+            if (lexer.getNext() != SQLLexer::Integer) {
+                throw ParserException("Expected digits after '.' in WHERE clause");
+            }
+            constant += "." + lexer.getTokenValue();
+            range.second = lexer.getTokenRange().second;
+        } else {
+            lexer.unget(token);
+        }
+    }
+    const int param = keep ? -1 : parameterizeConstant(constant, range);
+    if (param >= 0) {
+        constant = "?";
+    }
+    return param;
+}
+
+void SQLParser::parseInList(Predicate& predicate) {
+    if (lexer.getNext() != SQLLexer::ParOpen) {
+        throw ParserException("Expected '(' after IN");
+    }
+    while (true) {
+        SQLLexer::Token token = lexer.getNext();
+        if (token != SQLLexer::String && token != SQLLexer::Integer && token != SQLLexer::Questionmark) {
+            throw ParserException("Expected constant in IN list");
+        }
+        string constant;
+        const int param = parseConstant(token, false, constant);
+        predicate.values.push_back(constant);
+        predicate.params.push_back(param);
+
+        token = lexer.getNext();
+        if (token == SQLLexer::ParClose) {
+            return;
+        } else if (token != SQLLexer::Comma) {
+            throw ParserException("Expected ',' or ')' in IN list");
+        }
+    }
+}
+
+/// Warning: only handles expressions of a form attr1=attr2, attr op constant, attr BETWEEN constant AND constant,
+/// attr LIKE constant or attr IN (constant, ...), where op is one of =, <>, <, <=, > and >=. Equalities and IN lists
+/// of one column may be combined by OR, which is put in parentheses when there are other expressions.
 void SQLParser::parseWhere(Query* query) {
     SQLLexer::Token token = lexer.getNext();
 
@@ -132,6 +303,11 @@ void SQLParser::parseWhere(Query* query) {
         return;
     }
 
+    if (token == SQLLexer::Identifier && (lexer.isKeyword("group") || lexer.isKeyword("order") || lexer.isKeyword("limit"))) {
+        lexer.unget(token);
+        return;
+    }
+
     if (token != SQLLexer::Identifier || !lexer.isKeyword("where")) {
         throw ParserException("Missing WHERE clause");
     }
@@ -139,19 +315,95 @@ void SQLParser::parseWhere(Query* query) {
     bool isLeftSideReady = false;
     bool isExpressionReady = false;
     bool isJoin = false;
+    //The AND of a BETWEEN starts its upper bound, not the next expression
+    bool isBetween = false;
+    //The expression is ORed to the selection before it, which is on the same column
+    bool isOr = false;
+    //The expression before an OR was pushed to the selections since the last AND or '(', not to the join conditions
+    bool isSelected = false;
+    bool isInParentheses = false;
+    //AND binds tighter than OR, so an OR that is not in parentheses has to be the whole clause
+    bool hasAnd = false, hasOr = false;
+    CompareOp op = CompareOp::Equal;
     string attrLeft, attrRight;
     string constant;
+    int param = -1;
+    Predicate list;
 
     while (true) {
         token = lexer.getNext();
-        if (token == SQLLexer::Identifier && lexer.isKeyword("and")) {
+        if (token == SQLLexer::Identifier && lexer.isKeyword("and") && isBetween) {
+            if (!isExpressionReady) {
+                throw ParserException("Expected lower bound of BETWEEN");
+            }
+            isBetween = false;
+            isExpressionReady = false;
+            op = CompareOp::LessEqual;
+        } else if (token == SQLLexer::Identifier && lexer.isKeyword("and")) {
             if (!isExpressionReady) {
                 throw ParserException("Unexpected AND");
             }
+            if (isInParentheses) {
+                throw ParserException("Only an OR of one column can be in parentheses");
+            }
             isExpressionReady = false;
             isLeftSideReady = false;
+            isOr = false;
+            isSelected = false;
+            hasAnd = true;
+            op = CompareOp::Equal;
+        } else if (token == SQLLexer::Identifier && lexer.isKeyword("or")) {
+            if (!isExpressionReady || isBetween) {
+                throw ParserException("Unexpected OR");
+            }
+            isExpressionReady = false;
+            isLeftSideReady = false;
+            isOr = true;
+            hasOr = hasOr || !isInParentheses;
+            op = CompareOp::Equal;
+        } else if (token == SQLLexer::ParOpen) {
+            if (isLeftSideReady || isExpressionReady || isInParentheses) {
+                throw ParserException("Unexpected '(' in WHERE clause");
+            }
+            isInParentheses = true;
+            isSelected = false;
+            continue;
+        } else if (token == SQLLexer::ParClose) {
+            if (!isExpressionReady || !isInParentheses || isBetween) {
+                throw ParserException("Unexpected ')' in WHERE clause");
+            }
+            isInParentheses = false;
+            continue;
+        } else if (token == SQLLexer::Identifier && lexer.isKeyword("in")) {
+            if (!isLeftSideReady || isExpressionReady || op != CompareOp::Equal) {
+                throw ParserException("Unexpected IN");
+            }
+            op = CompareOp::In;
+            list = Predicate(op);
+            parseInList(list);
+            isExpressionReady = true;
+            isJoin = false;
+        } else if (token == SQLLexer::Identifier && (lexer.isKeyword("group") || lexer.isKeyword("order") || lexer.isKeyword("limit")) &&
+                   (isExpressionReady || !isLeftSideReady)) {
+            lexer.unget(token);
+            break;
+        } else if (token == SQLLexer::Identifier && lexer.isKeyword("like")) {
+            if (!isLeftSideReady || isExpressionReady || op != CompareOp::Equal) {
+                throw ParserException("Unexpected LIKE");
+            }
+            op = CompareOp::Like;
+        } else if (token == SQLLexer::Identifier && lexer.isKeyword("between")) {
+            if (!isLeftSideReady || isExpressionReady || op != CompareOp::Equal) {
+                throw ParserException("Unexpected BETWEEN");
+            }
+            op = CompareOp::GreaterEqual;
+            isBetween = true;
         } else if (token == SQLLexer::Identifier) {
-            if (isLeftSideReady) {
+            if (isLeftSideReady && op == CompareOp::Like) {
+                throw ParserException("LIKE needs a string constant");
+            } else if (isLeftSideReady && op != CompareOp::Equal) {
+                throw ParserException("Columns can only be compared for equality");
+            } else if (isLeftSideReady) {
                 attrRight = lexer.getTokenValue();
                 isExpressionReady = true;
                 isJoin = true;
@@ -166,32 +418,152 @@ void SQLParser::parseWhere(Query* query) {
                 throw ParserException("Error in WHERE clause @2");
             }
             continue;
-        } else if (token == SQLLexer::String || token == SQLLexer::Integer) {
+        } else if (token == SQLLexer::NotEqual || token == SQLLexer::Less || token == SQLLexer::LessEqual ||
+                   token == SQLLexer::Greater || token == SQLLexer::GreaterEqual) {
+            if (!isLeftSideReady || isExpressionReady || op != CompareOp::Equal) {
+                throw ParserException("Error in WHERE clause @3");
+            }
+            op = token == SQLLexer::NotEqual ? CompareOp::NotEqual :
+                 token == SQLLexer::Less ? CompareOp::Less :
+                 token == SQLLexer::LessEqual ? CompareOp::LessEqual :
+                 token == SQLLexer::Greater ? CompareOp::Greater : CompareOp::GreaterEqual;
+            continue;
+        } else if (token == SQLLexer::String || token == SQLLexer::Integer || token == SQLLexer::Questionmark) {
             if (!isLeftSideReady || isExpressionReady) {
                 throw ParserException("Unexpected String constant in WHERE clause");
             }
-            constant = lexer.getTokenValue();
+            //Patterns are kept, the scan chooses its kernel by them
+            param = parseConstant(token, op == CompareOp::Like, constant);
             isExpressionReady = true;
             isJoin = false;
         } else if (token == SQLLexer::Eof) {
             break;
-        } else if (token == SQLLexer::Questionmark) {
-            constant = "?";
-            isExpressionReady = true;
-            isJoin = false;
         } else {
             throw ParserException("Unexpected token: " + lexer.getTokenValue());
         }
 
         if (isExpressionReady) {
-            if (isJoin) {
+            Predicate predicate = op == CompareOp::In ? list : Predicate(op, constant, param);
+            if (isOr) {
+                //Equalities on one column are merged into an IN list
+                auto& previous = query->selection;
+                if (isJoin || !isSelected || previous.back().first != attrLeft ||
+                    (op != CompareOp::Equal && op != CompareOp::In) ||
+                    (previous.back().second.op != CompareOp::Equal && previous.back().second.op != CompareOp::In)) {
+                    throw ParserException("OR can only combine equalities of one column");
+                }
+                auto& merged = previous.back().second;
+                if (merged.op == CompareOp::Equal) {
+                    merged = Predicate({merged.value}, {merged.param});
+                }
+                if (op == CompareOp::Equal) {
+                    predicate = Predicate({constant}, {param});
+                }
+                merged.values.insert(merged.values.end(), predicate.values.begin(), predicate.values.end());
+                merged.params.insert(merged.params.end(), predicate.params.begin(), predicate.params.end());
+                isOr = false;
+            } else if (isJoin) {
                 query->joinConditions.push_back(make_pair(attrLeft, attrRight));
+                isSelected = false;
             } else {
-                query->selection.push_back(make_pair(attrLeft, constant));
+                query->selection.push_back(make_pair(attrLeft, predicate));
+                isSelected = true;
+            }
+        }
+    }
+
+    if (isBetween) {
+        throw ParserException("Missing AND of BETWEEN");
+    }
+    if (isInParentheses) {
+        throw ParserException("Missing ')' in WHERE clause");
+    }
+    if (hasOr && hasAnd) {
+        throw ParserException("An OR next to an AND has to be in parentheses");
+    }
+}
+
+void SQLParser::parseGroupBy(QuerySelect* query) {
+    SQLLexer::Token token = lexer.getNext();
+    //If we don't have a GROUP BY part, then return
+    if (token != SQLLexer::Identifier || !lexer.isKeyword("group")) {
+        lexer.unget(token);
+        return;
+    }
+
+    if (lexer.getNext() != SQLLexer::Identifier || !lexer.isKeyword("by")) {
+        throw ParserException("Expected 'BY' after 'GROUP'");
+    }
+
+    bool isColumnParsed = false;
+    while (true) {
+        token = lexer.getNext();
+        if (token == SQLLexer::Identifier && !isColumnParsed) {
+            query->groupBy.push_back(lexer.getTokenValue());
+            isColumnParsed = true;
+        } else if (token == SQLLexer::Comma) {
+            if (!isColumnParsed) {
+                throw ParserException("Unexpected Comma in the GROUP BY clause");
             }
+            isColumnParsed = false;
+        } else {
+            lexer.unget(token);
+            break;
+        }
+    }
+
+    if (!isColumnParsed) {
+        throw ParserException("Missing columns in GROUP BY clause");
+    }
+}
+
+void SQLParser::parseOrderBy(QuerySelect* query) {
+    SQLLexer::Token token = lexer.getNext();
+    //If we don't have an ORDER BY part, then return
+    if (token != SQLLexer::Identifier || !lexer.isKeyword("order")) {
+        lexer.unget(token);
+        return;
+    }
+
+    if (lexer.getNext() != SQLLexer::Identifier || !lexer.isKeyword("by")) {
+        throw ParserException("Expected 'BY' after 'ORDER'");
+    }
+
+    bool isColumnParsed = false;
+    while (true) {
+        token = lexer.getNext();
+        if (token == SQLLexer::Identifier && isColumnParsed && (lexer.isKeyword("asc") || lexer.isKeyword("desc"))) {
+            query->orderBy.back().second = lexer.isKeyword("desc");
+        } else if (token == SQLLexer::Identifier && !isColumnParsed) {
+            query->orderBy.push_back(make_pair(lexer.getTokenValue(), false));
+            isColumnParsed = true;
+        } else if (token == SQLLexer::Comma) {
+            if (!isColumnParsed) {
+                throw ParserException("Unexpected Comma in the ORDER BY clause");
+            }
+            isColumnParsed = false;
+        } else {
+            lexer.unget(token);
+            break;
         }
     }
 
+    if (!isColumnParsed) {
+        throw ParserException("Missing columns in ORDER BY clause");
+    }
+}
+
+void SQLParser::parseLimit(QuerySelect* query) {
+    SQLLexer::Token token = lexer.getNext();
+    if (token != SQLLexer::Identifier || !lexer.isKeyword("limit")) {
+        lexer.unget(token);
+        return;
+    }
+
+    if (lexer.getNext() != SQLLexer::Integer) {
+        throw ParserException("Expected number after 'LIMIT'");
+    }
+    query->limit = stol(lexer.getTokenValue());
 }
 
 void SQLParser::parseInsertColumns(QueryInsert* query) {
@@ -254,12 +626,15 @@ void SQLParser::parseInsertValues(QueryInsert* query) {
             if (currentColumn >= query->fields.size()) {
                 throw ParserException("Columns and Values count mismatch");
             }
-            query->fields[currentColumn].second = lexer.getTokenValue();
+            query->fields[currentColumn].second = parameterizeConstant() >= 0 ? "?" : lexer.getTokenValue();
             currentColumn++;
         } else if (token == SQLLexer::Questionmark) {
+            if (currentColumn >= query->fields.size()) {
+                throw ParserException("Columns and Values count mismatch");
+            }
             query->fields[currentColumn].second = "?";
             currentColumn++;
-            query->questionMarksReserved++;
+            parameters++;
         } else if (token == SQLLexer::Comma) {
             //skip
         } else {
@@ -311,12 +686,12 @@ void SQLParser::parseSet(QueryUpdate* query) {
             if (!isLeftSideReady || isExpressionReady) {
                 throw ParserException("Unexpected String constant in SET clause");
             }
-            constant = lexer.getTokenValue();
+            constant = parameterizeConstant() >= 0 ? "?" : lexer.getTokenValue();
             isExpressionReady = true;
         } else if (token == SQLLexer::Questionmark) {
             constant = "?";
             isExpressionReady = true;
-            query->questionMarksReserved++;
+            parameters++;
         } else if (token == SQLLexer::Eof) {
             break;
         } else {
@@ -335,12 +710,17 @@ Query* SQLParser::parse(Schema* schema) {
     //Create a magic ptr for simplicity sake
     Query* query;
     //We need to retain this in a tmp var as we can't yet assign it to the query
-    bool queryExplain = false;
+    bool queryExplain = false, queryAnalyze = false;
 
-    //Catch if the user wants the code to be shown instead of executed
+    //Catch if the user wants the code to be shown instead of executed, or executed with counters
     if (token == SQLLexer::Identifier && lexer.isKeyword("explain")) {
         queryExplain = true;
         token = lexer.getNext(); //Skip to the next identifier
+        if (token == SQLLexer::Identifier && lexer.isKeyword("analyze")) {
+            queryExplain = false;
+            queryAnalyze = true;
+            token = lexer.getNext();
+        }
     }
 
     // Make sure we have a identifier
@@ -356,6 +736,9 @@ Query* SQLParser::parse(Schema* schema) {
         parseFrom((QuerySelect*) query);
         parseFor((QuerySelect*) query);
         parseWhere(query);
+        parseGroupBy((QuerySelect*) query);
+        parseOrderBy((QuerySelect*) query);
+        parseLimit((QuerySelect*) query);
     } else if (lexer.isKeyword("update")) {
         //UPDATE table_name SET column1=value1,column2=value2,... WHERE some_column=some_value;
         query = new QueryUpdate(schema);
@@ -399,6 +782,12 @@ Query* SQLParser::parse(Schema* schema) {
     if (queryExplain) {
         query->explain = true;
     }
+    if (queryAnalyze) {
+        if (dynamic_cast<QuerySelect*>(query) == nullptr) {
+            throw ParserException("EXPLAIN ANALYZE is only supported for SELECT");
+        }
+        query->analyze = true;
+    }
 
     //Check that there is nothing left
     if (lexer.getNext() != SQLLexer::Eof) {
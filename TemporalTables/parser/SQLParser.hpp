@@ -19,12 +19,37 @@ class SQLParser {
 private:
     SQLLexer& lexer;
 
+    /// Replace the constants of the selections and the values of INSERT and UPDATE by parameters,
+    /// only for queries without question marks
+    bool parameterize;
+    /// Number of parameters so far, question marks and replaced constants in the order of the query
+    int parameters = 0;
+    /// Values of the replaced constants, in the order of their parameters
+    std::vector<std::string> constants;
+    /// Position of every replaced constant in the query
+    std::vector<std::pair<size_t, size_t>> constantRanges;
+
+    /// Index of the parameter that replaces the current constant, -1 if constants are kept
+    int parameterizeConstant();
+
+    /// Index of the parameter that replaces a constant of several tokens, given by its value and position
+    int parameterizeConstant(const std::string& value, std::pair<size_t, size_t> range);
+
     void parseSelect(QuerySelect*);
+    void parseAggregate(QuerySelect*, const std::string& function);
 
     void parseFrom(QuerySelect*);
     void parseFor(QuerySelect*);
 
     void parseWhere(Query*);
+    /// The constant or question mark of the token into constant, a number may have decimals. Returns the index of
+    /// its parameter, -1 if the constant is kept like a LIKE pattern is
+    int parseConstant(SQLLexer::Token token, bool keep, std::string& constant);
+    /// The parenthesized constants after IN into the values and params of the predicate
+    void parseInList(Predicate& predicate);
+    void parseGroupBy(QuerySelect*);
+    void parseOrderBy(QuerySelect*);
+    void parseLimit(QuerySelect*);
 
     void parseSet(QueryUpdate*);
 
@@ -37,11 +62,17 @@ public:
         ParserException(const std::string&);
     };
 
-    explicit SQLParser(SQLLexer&);
+    explicit SQLParser(SQLLexer&, bool parameterize = false);
 
     ~SQLParser();
 
     Query* parse(Schema*);
+
+    /// Values of the constants that were replaced by parameters, the params of the parsed query
+    const std::vector<std::string>& getConstants() const;
+
+    /// The query with a question mark for every constant that was replaced by a parameter
+    std::string getNormalizedQuery() const;
 };
 
 #endif
\ No newline at end of file
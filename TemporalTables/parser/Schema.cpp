@@ -43,6 +43,19 @@ string Schema::type(const Schema::Relation::Attribute& attr, bool cpp) {
     throw "type not found";
 }
 
+string Schema::minValue(const Schema::Relation::Attribute& attr) {
+    switch (attr.type) {
+        case Types::Tag::Integer:return "Integer(INT64_MIN)";
+        case Types::Tag::Date:return "Date(INT32_MIN)";
+        case Types::Tag::Datetime:
+        case Types::Tag::Timestamp:return "Timestamp(0ull)";
+        case Types::Tag::Numeric:return type(attr, 1) + "((int64_t) INT64_MIN)";
+        case Types::Tag::Char:
+        case Types::Tag::Varchar:return type(attr, 1) + "::castString(\"\", 0)";
+    }
+    throw "type not found";
+}
+
 static string pkList(const Schema::Relation& rel) {
     stringstream out;
     for (auto e : rel.primaryKey) {
@@ -65,6 +78,28 @@ static string pkListType(const Schema::Relation& rel) {
     return out.str();
 }
 
+static string indexList(const Schema::Relation& rel, const Schema::Relation::Index& index, const string& row) {
+    stringstream out;
+    for (size_t i = 0; i < index.keys.size(); i++) {
+        out << row << "." << rel.attributes[index.keys[i]].name;
+        if (i + 1 < index.keys.size()) {
+            out << ", ";
+        }
+    }
+    return out.str();
+}
+
+static string indexListType(const Schema::Relation& rel, const Schema::Relation::Index& index) {
+    stringstream out;
+    for (size_t i = 0; i < index.keys.size(); i++) {
+        out << Schema::type(rel.attributes[index.keys[i]], 1);
+        if (i + 1 < index.keys.size()) {
+            out << ", ";
+        }
+    }
+    return out.str();
+}
+
 string Schema::toString() const {
     stringstream out;
     for (const Schema::Relation& rel : relations) {
@@ -103,20 +138,17 @@ string Schema::toString() const {
 }
 
 void Schema::genIncludes(ostream& out) const {
-    out << "#include <iostream>" << endl
-        << "#include <cstdint>" << endl
-        << "#include <fstream>" << endl
+    out << "#include <cstdint>" << endl
+        << "#include <string>" << endl
         << "#include <vector>" << endl
         << "#include <utility>" << endl
-        << "#include <ctime>" << endl
         << "#include <unordered_map>" << endl
         << "#include <tuple>" << endl
         << "#include <map>" << endl
-        << "#include <sstream>" << endl
         << "#include \"../utils/Types.hpp\"" << endl
-        << "#include \"../utils/DatabaseTools.h\"" << endl
-        << "#include \"../utils/TupelHash.h\"" << endl;
-    //out << "#include \"btree/btree_map.h\"" << endl;
+        << "#include \"../utils/TupelHash.h\"" << endl
+        << "#include \"../utils/IndexTools.h\"" << endl
+        << "#include \"../btree/btree_map.h\"" << endl;
 }
 
 void Schema::genRowDef(ostream& out, const Schema::Relation& rel, bool hasPK) const {
@@ -168,11 +200,20 @@ void Schema::genRelation(ostream& out, const Schema::Relation& rel) const {
     if (rel.systemVersioning) {
         out << "        std::multimap<pkType, u_int32_t> pkHistory{};" << endl;
     }
-    /*if (rel.indexes.size() > 0) {
-        for (auto& e : rel.indexes) {
-            out << "        //TODO ADD INDEXES" << endl;
+
+    //Ordered indexes for key prefix lookups, temporal tables keep every version in the table so they only get pkHistory
+    const bool ordered = !rel.systemVersioning;
+    if (ordered && hasPK) {
+        out << "        btree::btree_map<pkType, u_int32_t> pkTree{};" << endl;
+    }
+    if (ordered) {
+        for (auto& index : rel.indexes) {
+            out << "        using " << index.name << "Type = std::tuple<" << indexListType(rel, index) << ">;" << endl;
+            out << "        btree::btree_multimap<" << index.name << "Type, u_int32_t> " << index.name << "{};" << endl;
+            out << "        static " << index.name << "Type " << index.name << "Key(const Row& r) { return std::make_tuple("
+                << indexList(rel, index, "r") << "); }" << endl;
         }
-    }*/
+    }
 
     //Some table functions that are useful
     out << "        size_t size() { return table.size(); }" << endl;
@@ -196,7 +237,16 @@ void Schema::genRelation(ostream& out, const Schema::Relation& rel) const {
             << "        insert(element);" << endl
             << "    }" << endl;
     } else if (hasPK) { //Don't allow updating rows, if the table does not have a PK
-        out << "        void update(Row& element) { table[pk[element.key()]] = element; }" << endl;
+        out << "        void update(Row& element) {" << endl;
+        out << "            const u_int32_t i = pk[element.key()];" << endl;
+        for (auto& index : rel.indexes) {
+            out << "            if (!(" << index.name << "Key(table[i]) == " << index.name << "Key(element))) {" << endl;
+            out << "                IndexTools::eraseIndexEntry(" << index.name << ", " << index.name << "Key(table[i]), i);" << endl;
+            out << "                " << index.name << ".insert(std::make_pair(" << index.name << "Key(element), i));" << endl;
+            out << "            }" << endl;
+        }
+        out << "            table[i] = element;" << endl;
+        out << "        }" << endl;
     }
 
     //Removing elements
@@ -207,15 +257,27 @@ void Schema::genRelation(ostream& out, const Schema::Relation& rel) const {
         out << "pk.erase(r.key()); " << endl;//Remove from "current" pk
         //Entry already should be in history table through correct insert
     } else {
+        //Move the last row into the gap and point its index entries there
         if (hasPK) {
             out << "            const auto key = row(i).key();" << endl;
             out << "            pk.erase(key);" << endl;
+            out << "            pkTree.erase(key);" << endl;
         }
-        out << "            std::iter_swap(table.begin() +i, table.end()-1);\n";
-        out << "            table.pop_back();" << endl;
+        for (auto& index : rel.indexes) {
+            out << "            IndexTools::eraseIndexEntry(" << index.name << ", " << index.name << "Key(table[i]), i);" << endl;
+        }
+        out << "            const u_int32_t last = table.size() - 1;" << endl;
+        out << "            if (i != last) {" << endl;
+        out << "                table[i] = table[last];" << endl;
         if (hasPK) {
-            out << "            pk[table[i].key()] = i;" << endl;
+            out << "                pk[table[i].key()] = i;" << endl;
+            out << "                pkTree[table[i].key()] = i;" << endl;
+        }
+        for (auto& index : rel.indexes) {
+            out << "                IndexTools::moveIndexEntry(" << index.name << ", " << index.name << "Key(table[i]), last, i);" << endl;
         }
+        out << "            }" << endl;
+        out << "            table.pop_back();" << endl;
     }
     out << "        }" << endl;
 
@@ -232,6 +294,14 @@ void Schema::genRelation(ostream& out, const Schema::Relation& rel) const {
     if (hasPK) {
         out << "            pk[element.key()] = table.size() - 1;" << endl;
     }
+    if (ordered && hasPK) {
+        out << "            pkTree[element.key()] = table.size() - 1;" << endl;
+    }
+    if (ordered) {
+        for (auto& index : rel.indexes) {
+            out << "            " << index.name << ".insert(std::make_pair(" << index.name << "Key(element), table.size() - 1));" << endl;
+        }
+    }
     if (rel.systemVersioning) {
         out << "pkHistory.insert(make_pair(element.key(), table.size() - 1));" << endl;
     }
@@ -252,8 +322,9 @@ void Schema::genRelation(ostream& out, const Schema::Relation& rel) const {
     out << "    };" << endl;
 }
 
-string Schema::generateDatabaseCode() const {
+string Schema::generateDatabaseHeader() const {
     stringstream out;
+    out << "#pragma once" << endl;
     genIncludes(out);
 
     out << "struct Database {" << endl;
@@ -271,19 +342,31 @@ string Schema::generateDatabaseCode() const {
         out << "\t";
         out << rel.getTypeRelationName() << " " << rel.name << ";" << endl;
     }
+    out << "    void import(const std::string &path);" << endl;
+
+    // End struct Database
+    out << "};" << endl;
+
+    return out.str();
+}
+
+string Schema::generateDatabaseCode(const string& header) const {
+    stringstream out;
+    out << "#include \"" << header << "\"" << endl;
+    out << "#include <iostream>" << endl
+        << "#include <cstddef>" << endl
+        << "#include \"../utils/DatabaseTools.h\"" << endl
+        << "#include \"../utils/TableLayout.h\"" << endl;
 
     // Import any data into our database
-    out << "    void import(const std::string &path) {" << endl;
+    out << "void Database::import(const std::string &path) {" << endl;
     for (const Schema::Relation& rel : relations) {
         out << "       DatabaseTools::loadTableFromFile(";
         out << rel.name << ", path + \"tpcc_" << rel.name << ".tbl\");\n" << endl;
         out << "       std::cout << \"\\t";
         out << rel.getTypeRelationName() << ": \" << " << rel.name << ".size() << std::endl;" << endl;
     }
-    out << "    }" << endl;
-
-    // End struct Database
-    out << "};" << endl;
+    out << "}" << endl;
 
     // Allow db to be loaded dynamically
     out << "extern \"C\" Database* make_database(std::string filename) {\n"
@@ -298,6 +381,75 @@ string Schema::generateDatabaseCode() const {
             "    return db->warehouseold.size();\n"
             "}";
 
+    // Statistics of all relations for the planner, only the rows added since the last call are analyzed
+    out << endl << "extern \"C\" void analyzeTable(Database* db, const std::string& name, TableStatistics& statistics) {" << endl;
+    for (const Schema::Relation& rel : relations) {
+        out << "    if (name == \"" << rel.name << "\") {" << endl;
+        out << "        auto& table = db->" << rel.name << ".table;" << endl;
+        out << "        const size_t from = statistics.extend(table.size(), " << rel.attributes.size() << ");" << endl;
+        for (size_t i = 0; i < rel.attributes.size(); i++) {
+            out << "        DatabaseTools::analyzeColumn<" << type(rel.attributes[i], 1) << ">(table.data(), sizeof(Database::"
+                << rel.getTypeRelationName() << "::Row), offsetof(Database::" << rel.getTypeRelationName() << "::Row, "
+                << rel.attributes[i].name << "), from, table.size(), statistics.columns[" << i << "]);" << endl;
+        }
+        out << "    }" << endl;
+    }
+    out << "}" << endl;
+
+    // Access to the rows for the interpreter, which is not compiled against the database
+    out << endl << "extern \"C\" void tableLayout(Database* db, const std::string& name, TableLayout& layout) {" << endl;
+    for (const Schema::Relation& rel : relations) {
+        const string row = "Database::" + rel.getTypeRelationName() + "::Row";
+        out << "    if (name == \"" << rel.name << "\") {" << endl;
+        out << "        auto& table = db->" << rel.name << ".table;" << endl;
+        out << "        layout.rows = reinterpret_cast<const char*>(table.data());" << endl;
+        out << "        layout.count = table.size();" << endl;
+        out << "        layout.rowSize = sizeof(" << row << ");" << endl;
+        out << "        layout.offsets = {";
+        for (size_t i = 0; i < rel.attributes.size(); i++) {
+            out << (i ? ", " : "") << "offsetof(" << row << ", " << rel.attributes[i].name << ")";
+        }
+        out << "};" << endl;
+        out << "    }" << endl;
+    }
+    out << "}" << endl;
+
+    //The rows are removed from the back, removing a row moves the last row into its place
+    out << endl << "extern \"C\" void removeRows(Database* db, const std::string& name, const std::vector<uint32_t>& rows) {" << endl;
+    for (const Schema::Relation& rel : relations) {
+        out << "    if (name == \"" << rel.name << "\") {" << endl;
+        out << "        for (auto i = rows.rbegin(); i != rows.rend(); ++i) {" << endl;
+        out << "            db->" << rel.name << ".remove(*i);" << endl;
+        out << "        }" << endl;
+        out << "    }" << endl;
+    }
+    out << "}" << endl;
+
+    //Set the columns of the rows to the values, given as strings with the index of their column
+    out << endl << "extern \"C\" void updateRows(Database* db, const std::string& name, const std::vector<uint32_t>& rows, "
+            "const std::vector<std::pair<size_t, std::string>>& values) {" << endl;
+    for (const Schema::Relation& rel : relations) {
+        if (rel.primaryKey.empty() && !rel.systemVersioning) {
+            continue;
+        }
+        out << "    if (name == \"" << rel.name << "\") {" << endl;
+        out << "        for (auto i : rows) {" << endl;
+        out << "            auto e = db->" << rel.name << ".row((size_t) i);" << endl;
+        out << "            for (auto& v : values) {" << endl;
+        out << "                switch (v.first) {" << endl;
+        for (size_t i = 0; i < rel.attributes.size(); i++) {
+            auto& name = rel.attributes[i].name;
+            out << "                    case " << i << ": e." << name << " = e." << name
+                << ".castString(v.second.c_str(), v.second.size()); break;" << endl;
+        }
+        out << "                }" << endl;
+        out << "            }" << endl;
+        out << "            db->" << rel.name << ".update(e);" << endl;
+        out << "        }" << endl;
+        out << "    }" << endl;
+    }
+    out << "}" << endl;
+
     return out.str();
 }
 
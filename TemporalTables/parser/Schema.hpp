@@ -5,6 +5,7 @@
 #include <string>
 #include <cmath>
 #include <cstdint>
+#include "../utils/Statistics.h"
 
 using namespace std;
 
@@ -51,6 +52,9 @@ struct Schema {
         bool systemVersioning = false;
         std::pair<int, int> systemVersioningPeriod;
 
+        /// Row count and column statistics for the estimates of the planner, see ANALYZE
+        TableStatistics statistics;
+
         int findAttributeIndex(const std::string& name);
 
         Schema::Relation::Attribute& findAttribute(const std::string& name);
@@ -72,9 +76,16 @@ struct Schema {
 
     std::vector<Schema::Relation> relations;
 
+    /// Hash of the generated database code, the compiled queries of other versions cannot be reused
+    std::string version;
+
     std::string toString() const;
 
-    std::string generateDatabaseCode() const;
+    /// The layout of the relations with their inline accessors, all that the compiled queries need
+    std::string generateDatabaseHeader() const;
+
+    /// Import and statistics of the relations, compiled once into the database library next to the header
+    std::string generateDatabaseCode(const std::string& header) const;
 
     void genIncludes(ostream& out) const;
     void genRelation(ostream& out, const Schema::Relation&) const;
@@ -84,6 +95,9 @@ struct Schema {
 
     static string type(const Relation::Attribute& attr, bool cpp = 0);
 
+    /// C++ expression for the smallest value of the attribute's type, to seek to the start of a key prefix
+    static string minValue(const Relation::Attribute& attr);
+
     ostream& genIncludes();
 };
 
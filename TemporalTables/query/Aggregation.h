@@ -0,0 +1,44 @@
+#ifndef TASK5_AGGREGATION_H
+#define TASK5_AGGREGATION_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+/// Aggregate functions of the select list
+enum class AggregateOp {
+    Count, Sum, Min, Max, Avg
+};
+
+/// An aggregate of the select list, like sum(ol_quantity * ol_amount) as total
+struct AggregateItem {
+    AggregateOp op;
+    /// Tokens of the argument: columns, constants, + - * and parentheses. Empty for count(*)
+    std::vector<std::string> argument;
+    /// Name of the output column
+    std::string name;
+};
+
+inline const char* aggregateName(AggregateOp op) {
+    switch (op) {
+        case AggregateOp::Count: return "count";
+        case AggregateOp::Sum: return "sum";
+        case AggregateOp::Min: return "min";
+        case AggregateOp::Max: return "max";
+        case AggregateOp::Avg: return "avg";
+    }
+    return "";
+}
+
+inline std::ostream& operator<<(std::ostream& out, const AggregateItem& item) {
+    out << aggregateName(item.op) << "(";
+    if (item.argument.empty()) {
+        out << "*";
+    }
+    for (auto& token : item.argument) {
+        out << token;
+    }
+    return out << ") as " << item.name;
+}
+
+#endif //TASK5_AGGREGATION_H
@@ -1,5 +1,6 @@
 
 #include "Delete.h"
+#include "../interpreter/Interpreter.h"
 
 using namespace std;
 
@@ -10,26 +11,29 @@ string QueryDelete::toString() const {
     out << relation << endl;
     out << "WHERE: \n\t ";
     for (auto& e : this->selection) {
-        out << get<0>(e) << "=" << get<1>(e) << " ";
+        out << get<0>(e) << get<1>(e) << " ";
     }
 
     return out.str();
 }
 
 
-string QueryDelete::generateQueryCode() {
-    ostringstream out;
-
-    Operator* finder;
-    auto& rel = schema->findRelation(relation);
+Operator* QueryDelete::finder(Schema::Relation& rel, selectionType& selectionConditions) {
     auto ts = new TableScan(rel);
-    auto selectionConditions = getSelections(ts);
+    selectionConditions = getSelections(ts);
 
     if (selectionConditions.size() > 0) {
-        finder = new Selection(shared_ptr<TableScan>(ts), selectionConditions);
-    } else {
-        finder = ts;
+        return new Selection(shared_ptr<TableScan>(ts), selectionConditions);
     }
+    return ts;
+}
+
+string QueryDelete::generateQueryCode() {
+    ostringstream out;
+
+    auto& rel = schema->findRelation(relation);
+    selectionType selectionConditions;
+    Operator* finder = this->finder(rel, selectionConditions);
 
     Delete* u = new Delete(*finder, selectionConditions, rel);
     out << u->produce();
@@ -38,3 +42,12 @@ string QueryDelete::generateQueryCode() {
     delete finder;
     return out.str();
 }
+
+bool QueryDelete::interpret(Interpreter& interpreter) {
+    auto& rel = schema->findRelation(relation);
+    selectionType selectionConditions;
+    unique_ptr<Operator> finder(this->finder(rel, selectionConditions));
+
+    Delete remove(*finder, selectionConditions, rel);
+    return interpreter.run(remove);
+}
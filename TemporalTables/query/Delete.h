@@ -14,12 +14,17 @@ class QueryDelete : public Query {
     string relation;
     Schema* schema;
 
+    /// The scan with the selections of the rows to delete
+    Operator* finder(Schema::Relation& rel, selectionType& selectionConditions);
+
 public:
     QueryDelete(Schema* s) : schema(s) { }
     ~QueryDelete() { }
     virtual string toString() const;
 
     virtual string generateQueryCode();
+
+    virtual bool interpret(Interpreter& interpreter);
 };
 
 
@@ -1,5 +1,6 @@
 
 #include "Insert.h"
+#include "../operators/Operator.h"
 
 
 using namespace std;
@@ -25,23 +26,23 @@ string QueryInsert::generateQueryCode() {
     out << "auto r = Database::";
     out << r.getTypeRelationName() << "::Row{};\n" << endl;
     out << "try {" << endl;
-    int currentVar = 0;
     for (auto& field : r.attributes) {
         string val = "";
+        //Parameters are numbered in the order of the values
+        int param = 0;
         for (auto& findVal : fields) {
             if (field.name == findVal.first) {
                 val = findVal.second;
+                break;
             }
-        }
-        if (val.length() > 0) {
-            out << "r." << field.name << " = r." << field.name << ".castString(";
-            if (val == "?") {
-                out << "params[" << currentVar << "].c_str(), " << "params[" << currentVar << "].size()";
-                currentVar++;
-            } else {
-                out << "\"" << val << "\", " << val.size();
+            if (findVal.second == "?") {
+                param++;
             }
-            out << ");" << endl;
+        }
+        if (val == "?") {
+            out << "r." << field.name << " = " << Operator::parameter(param, Schema::type(field, true)) << ";" << endl;
+        } else if (val.length() > 0) {
+            out << "r." << field.name << " = r." << field.name << ".castString(" << Operator::literal(val) << ", " << val.size() << ");" << endl;
         } else if (field.type == Types::Tag::Date) {
             out << "r." << field.name << " = r." << field.name << ".castString(\"0000-01-01\", 10);" << endl;
         } else if (field.type == Types::Tag::Datetime) {
@@ -0,0 +1,397 @@
+#include "JoinOrder.h"
+#include "../operators/HashJoin.h"
+#include "../operators/IndexJoin.h"
+#include "../parser/ParserError.h"
+#include "../utils/Types.hpp"
+
+using namespace std;
+
+/// Selectivity of an equality selection or join condition on columns that are no key
+static const double equalitySelectivity = 0.1;
+/// Selectivity of a LIKE pattern
+static const double likeSelectivity = 0.25;
+/// Selectivity of a bound of a range without statistics of the column or the value
+static const double rangeSelectivity = 1.0 / 3;
+
+vector<string> JoinOrder::parameterValues;
+
+/// The constant of a selection, or the value of its parameter at the first execution, "?" if neither is known
+static const string& constantOf(const string& value, int param) {
+    if (value == "?" && param >= 0 && (size_t) param < JoinOrder::parameterValues.size()) {
+        return JoinOrder::parameterValues[param];
+    }
+    return value;
+}
+
+/// Selectivity of a selection without statistics of its column
+static double guessSelectivity(const Predicate& predicate) {
+    switch (predicate.op) {
+        case CompareOp::Equal:
+            return equalitySelectivity;
+        case CompareOp::Like:
+            return likeSelectivity;
+        case CompareOp::NotEqual:
+            return 1 - equalitySelectivity;
+        case CompareOp::In:
+            return min(1.0, predicate.values.size() * equalitySelectivity);
+        default:
+            return rangeSelectivity;
+    }
+}
+
+/// Check if the columns include all columns of the primary key of the relation
+static bool coversKey(const Schema::Relation& relation, const set<string>& columns) {
+    if (relation.primaryKey.empty()) {
+        return false;
+    }
+    for (auto key : relation.primaryKey) {
+        if (!columns.count(relation.attributes[key].name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t only(uint64_t set) {
+    return (size_t) __builtin_ctzll(set);
+}
+
+JoinOrder::JoinOrder(vector<Input>& inputs)
+        : inputs(inputs), conditions(inputs.size(), vector<vector<tuple<IU*, IU*>>>(inputs.size())),
+          selectivities(inputs.size(), vector<double>(inputs.size(), 1)) {
+    if (inputs.size() > maxInputs) {
+        throw ParserError(0, "Too many relations to order the joins, at most " + to_string(maxInputs) + " are supported.");
+    }
+}
+
+void JoinOrder::addConditions(size_t i, size_t j, const vector<tuple<IU*, IU*>>& conditions) {
+    if (conditions.empty()) {
+        return;
+    }
+    this->conditions[i][j] = conditions;
+    for (auto& c : conditions) {
+        this->conditions[j][i].emplace_back(get<1>(c), get<0>(c));
+    }
+    selectivities[i][j] = selectivities[j][i] = joinSelectivity(conditions, inputs[i].selections, inputs[j].selections);
+}
+
+double JoinOrder::rowCount(const Schema::Relation& relation) {
+    return max<double>(1, relation.statistics.rows);
+}
+
+/// Statistics of the column of the IU, nullptr if its relation was not analyzed
+static const ColumnStatistics* columnStatistics(IU* iu) {
+    auto& statistics = iu->rel->getRelation().statistics;
+    const size_t column = iu->attr - iu->rel->getRelation().attributes.data();
+    return statistics.valid() ? &statistics.columns[column] : nullptr;
+}
+
+/// Key of a constant in the statistics of its column, NaN if it cannot be cast to the type of the column
+static double constantKey(const Schema::Relation::Attribute& attr, const string& value) {
+    try {
+        switch (attr.type) {
+            case Types::Tag::Integer:
+                return Integer::castString(value.c_str(), (uint32_t) value.size()).value;
+            case Types::Tag::Numeric:
+                return stod(value) * pow(10, attr.len2);
+            case Types::Tag::Date:
+                return Date::castString(value.c_str(), (uint32_t) value.size()).value;
+            case Types::Tag::Timestamp:
+            case Types::Tag::Datetime:
+                return Timestamp::castString(value.c_str(), (uint32_t) value.size()).value;
+            case Types::Tag::Char:
+            case Types::Tag::Varchar:
+                return ColumnStatistics::stringKey(value.data(), value.size());
+        }
+    } catch (...) {
+    }
+    return numeric_limits<double>::quiet_NaN();
+}
+
+/// Fraction of the rows of a column matching the predicate, from the statistics of the column
+static double selectivity(const ColumnStatistics& column, const Schema::Relation::Attribute& attr, const Predicate& predicate) {
+    const double distinct = 1 / column.distinct();
+    if (predicate.op == CompareOp::In) {
+        //The values of a list are assumed to be distinct
+        double result = 0;
+        for (size_t i = 0; i < predicate.values.size(); i++) {
+            result += ::selectivity(column, attr, Predicate(CompareOp::Equal, predicate.values[i], predicate.params[i]));
+        }
+        return min(1.0, result);
+    }
+    const string& value = constantOf(predicate.value, predicate.param);
+    if (value == "?" || isRange(predicate.op)) {
+        switch (predicate.op) {
+            case CompareOp::Equal:
+                return distinct;
+            case CompareOp::NotEqual:
+                return 1 - distinct;
+            default:
+                return guessSelectivity(predicate);
+        }
+    }
+
+    if (predicate.op == CompareOp::NotEqual) {
+        return 1 - ::selectivity(column, attr, Predicate(CompareOp::Equal, value, -1));
+    }
+    if (predicate.op == CompareOp::Equal) {
+        //Constants outside of the values of the column match nothing, the rest is assumed to be evenly distributed
+        const double key = constantKey(attr, value);
+        if (key < column.min || key > column.max) {
+            return 1 / max<double>(1, column.count);
+        }
+        return distinct;
+    }
+
+    //A pattern starting with a prefix matches the range of strings with the prefix
+    const string prefix = value.substr(0, value.find_first_of("%_"));
+    if (prefix.empty()) {
+        return likeSelectivity;
+    }
+    if (prefix.size() == value.size()) {
+        return distinct;
+    }
+    string last = prefix + string(8, (char) 0xff);
+    const double range = column.range(ColumnStatistics::stringKey(prefix.data(), prefix.size()),
+                                      ColumnStatistics::stringKey(last.data(), last.size()));
+    return max(range, distinct);
+}
+
+double JoinOrder::selectivity(const Schema::Relation& relation, const selectionType& selections) {
+    set<string> equal;
+    //The constant bounds of a column, the lower and the upper bound of a BETWEEN are not independent
+    map<IU*, pair<double, double>> bounds;
+    double result = 1;
+    for (auto& s : selections) {
+        if (s.second.op == CompareOp::Equal) {
+            equal.insert(s.first->attr->name);
+        }
+        auto column = columnStatistics(s.first);
+        const string& value = constantOf(s.second.value, s.second.param);
+        if (column && isRange(s.second.op) && value != "?") {
+            const double key = constantKey(*s.first->attr, value);
+            if (!std::isnan(key)) {
+                auto& bound = bounds.emplace(s.first, make_pair(column->min, column->max)).first->second;
+                if (s.second.op == CompareOp::Greater || s.second.op == CompareOp::GreaterEqual) {
+                    bound.first = max(bound.first, key);
+                } else {
+                    bound.second = min(bound.second, key);
+                }
+                continue;
+            }
+        }
+        if (column) {
+            result *= ::selectivity(*column, *s.first->attr, s.second);
+        } else {
+            result *= guessSelectivity(s.second);
+        }
+    }
+    for (auto& bound : bounds) {
+        auto column = columnStatistics(bound.first);
+        result *= max(column->range(bound.second.first, bound.second.second), 1 / max<double>(1, column->count));
+    }
+
+    //A constant key matches at most one row
+    if (coversKey(relation, equal)) {
+        return min(result, 1 / rowCount(relation));
+    }
+    return result;
+}
+
+/// Distinct combinations of the values of the columns, at most one per row
+static double distinct(const Schema::Relation& relation, const set<IU*>& columns) {
+    double result = 1;
+    for (auto iu : columns) {
+        auto column = columnStatistics(iu);
+        if (!column) {
+            //Without statistics guess that a tenth of the rows share a value
+            return max(1.0, equalitySelectivity * JoinOrder::rowCount(relation));
+        }
+        result *= column->distinct();
+    }
+    return min(result, JoinOrder::rowCount(relation));
+}
+
+/// Columns that are equal to a constant or parameter after the selections
+static set<string> constantColumns(const selectionType& selections) {
+    set<string> columns;
+    for (auto& s : selections) {
+        if (s.second.op == CompareOp::Equal) {
+            columns.insert(s.first->attr->name);
+        }
+    }
+    return columns;
+}
+
+/// Rows of a relation left by the equality selections on its key columns, the key values that can still be joined
+static double keyRows(const Schema::Relation& relation, const selectionType& selections) {
+    selectionType key;
+    for (auto& s : selections) {
+        for (auto k : relation.primaryKey) {
+            if (s.first->attr->name == relation.attributes[k].name && s.second.op == CompareOp::Equal) {
+                key.push_back(s);
+            }
+        }
+    }
+    return max(1.0, JoinOrder::rowCount(relation) * JoinOrder::selectivity(relation, key));
+}
+
+double JoinOrder::joinSelectivity(const vector<tuple<IU*, IU*>>& conditions, const selectionType& leftSelections, const selectionType& rightSelections) {
+    auto& left = get<0>(conditions.front())->rel->getRelation();
+    auto& right = get<1>(conditions.front())->rel->getRelation();
+
+    //Conditions between columns that are equal to the same constant or parameter on both sides hold for all remaining tuples
+    const set<string> leftConstants = constantColumns(leftSelections), rightConstants = constantColumns(rightSelections);
+    set<string> leftColumns(leftConstants), rightColumns(rightConstants);
+    set<IU*> leftIUs, rightIUs;
+    for (auto& c : conditions) {
+        if (leftConstants.count(get<0>(c)->attr->name) && rightConstants.count(get<1>(c)->attr->name)) {
+            continue;
+        }
+        leftColumns.insert(get<0>(c)->attr->name);
+        rightColumns.insert(get<1>(c)->attr->name);
+        leftIUs.insert(get<0>(c));
+        rightIUs.insert(get<1>(c));
+    }
+    if (leftIUs.empty()) {
+        return 1;
+    }
+
+    //A foreign key joins every tuple with at most one tuple of the relation whose key it references
+    const bool leftKey = coversKey(left, leftColumns), rightKey = coversKey(right, rightColumns);
+    if (leftKey && rightKey) {
+        return 1 / max(keyRows(left, leftSelections), keyRows(right, rightSelections));
+    } else if (leftKey) {
+        return 1 / keyRows(left, leftSelections);
+    } else if (rightKey) {
+        return 1 / keyRows(right, rightSelections);
+    }
+
+    //Otherwise every value of the side with fewer distinct values finds its matches on the other side
+    return 1 / max(distinct(left, leftIUs), distinct(right, rightIUs));
+}
+
+vector<tuple<IU*, IU*>> JoinOrder::between(uint64_t left, uint64_t right) const {
+    vector<tuple<IU*, IU*>> result;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!(left & (1ull << i))) {
+            continue;
+        }
+        for (size_t j = 0; j < inputs.size(); j++) {
+            if (right & (1ull << j)) {
+                result.insert(result.end(), conditions[i][j].begin(), conditions[i][j].end());
+            }
+        }
+    }
+    return result;
+}
+
+void JoinOrder::enumerate() {
+    const uint64_t all = (1ull << inputs.size()) - 1;
+    plans.assign(all + 1, Plan());
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        auto& relation = inputs[i].scan->getRelation();
+        auto& plan = plans[1ull << i];
+        plan.rows = rowCount(relation) * selectivity(relation, inputs[i].selections);
+        plan.cost = inputs[i].indexed ? plan.rows : rowCount(relation);
+    }
+
+    //Subsets are enumerated after all their subsets, every split into two connected parts is a candidate
+    for (uint64_t set = 1; set <= all; set++) {
+        if (!(set & (set - 1))) {
+            continue;
+        }
+        auto& plan = plans[set];
+        for (uint64_t left = (set - 1) & set; left > 0; left = (left - 1) & set) {
+            const uint64_t right = set ^ left;
+            const Plan& l = plans[left];
+            const Plan& r = plans[right];
+            if (l.cost == numeric_limits<double>::infinity() || r.cost == numeric_limits<double>::infinity()) {
+                continue;
+            }
+
+            double selectivity = 1;
+            for (size_t i = 0; i < inputs.size(); i++) {
+                for (size_t j = 0; j < inputs.size(); j++) {
+                    if ((left & (1ull << i)) && (right & (1ull << j))) {
+                        selectivity *= selectivities[i][j];
+                    }
+                }
+            }
+            auto joinConditions = between(left, right);
+            if (joinConditions.empty()) {
+                continue;
+            }
+            const double rows = l.rows * r.rows * selectivity;
+
+            //Build the hash table on the left side and probe it with the right side
+            double cost = l.cost + r.cost + l.rows + rows;
+            IndexScan::Access access;
+
+            //Or look up the matches of a single relation on the right side in one of its indexes
+            if (!(right & (right - 1))) {
+                auto& input = inputs[only(right)];
+                auto candidate = IndexScan::findIndex(input.scan->getRelation(),
+                                                      IndexJoin::knownValues(*input.scan, joinConditions, input.selections),
+                                                      IndexJoin::joinColumns(*input.scan, joinConditions));
+                const double indexCost = l.cost + l.rows * probeCost + rows;
+                if (candidate.valid() && indexCost < cost) {
+                    cost = indexCost;
+                    access = candidate;
+                }
+            }
+
+            if (cost < plan.cost) {
+                plan.rows = rows;
+                plan.cost = cost;
+                plan.left = left;
+                plan.right = right;
+                plan.access = access;
+            }
+        }
+    }
+
+    //Check that there are join conditions and we are not doing a cross join
+    if (plans[all].cost == numeric_limits<double>::infinity()) {
+        throw ParserError(0, "No join condition, hash join not possible.");
+    }
+}
+
+Operator* JoinOrder::build(vector<Input*>& scanned) {
+    enumerate();
+    return build((1ull << inputs.size()) - 1, scanned);
+}
+
+Operator* JoinOrder::build(uint64_t set, vector<Input*>& scanned) {
+    auto& plan = plans[set];
+    if (plan.left == 0) {
+        auto& input = inputs[only(set)];
+        scanned.push_back(&input);
+        return input.op;
+    }
+
+    Operator* left = build(plan.left, scanned);
+    if (plan.access.valid()) {
+        auto& input = inputs[only(plan.right)];
+        return new IndexJoin(*left, *input.op, *input.scan, between(plan.left, plan.right), plan.access);
+    }
+    Operator* right = build(plan.right, scanned);
+    return new HashJoin(*left, *right, between(plan.left, plan.right));
+}
+
+string JoinOrder::toString() const {
+    return plans.empty() ? "" : toString((1ull << inputs.size()) - 1);
+}
+
+string JoinOrder::toString(uint64_t set) const {
+    auto& plan = plans[set];
+    stringstream out;
+    if (plan.left == 0) {
+        out << inputs[only(set)].scan->getRelation().name;
+    } else {
+        out << "(" << toString(plan.left) << (plan.access.valid() ? " INDEX JOIN " : " JOIN ") << toString(plan.right) << ")";
+    }
+    out << " [" << (uint64_t) plan.rows << "]";
+    return out.str();
+}
@@ -0,0 +1,92 @@
+#ifndef TASK5_JOINORDER_H
+#define TASK5_JOINORDER_H
+
+#include <vector>
+#include <limits>
+#include "Query.h"
+#include "../operators/IndexScan.h"
+
+using namespace std;
+
+/// Chooses the order of the joins of a select and the build side of every hash join with dynamic programming over
+/// the connected subsets of its relations (DPsub). The cost of a plan is the number of tuples it scans, inserts into
+/// hash tables, looks up in indexes and produces, estimated from the row counts of the relations, the selectivity of
+/// their selections and of the join conditions. The selectivities come from the column statistics of the relations
+/// (distinct counts and histograms) or from fixed guesses if they were not analyzed.
+/// The plan does not depend on the order of the from clause.
+class JoinOrder {
+public:
+    /// A relation of the from clause, with its selections on top
+    struct Input {
+        TableScan* scan;
+        Operator* op;
+        selectionType selections;
+        /// Only the rows matching an equality or range selection are visited through an index
+        bool indexed;
+    };
+
+private:
+    /// The cheapest plan found for a set of inputs, sets are bit masks of the positions in inputs
+    struct Plan {
+        double rows = 0;
+        double cost = numeric_limits<double>::infinity();
+        /// Both sides of the join, 0 for a single input. The left side is built into the hash table
+        /// or is the outer side of an index join
+        uint64_t left = 0;
+        uint64_t right = 0;
+        /// Index probed for the single input of the right side, invalid for a hash join
+        IndexScan::Access access;
+    };
+
+    vector<Input>& inputs;
+    /// Join conditions between two inputs, the IU of the first input first
+    vector<vector<vector<tuple<IU*, IU*>>>> conditions;
+    /// Selectivity of the join conditions between two inputs, 1 if there are none
+    vector<vector<double>> selectivities;
+    vector<Plan> plans;
+
+    /// Join conditions between two disjoint sets, the IU of the left set first
+    vector<tuple<IU*, IU*>> between(uint64_t left, uint64_t right) const;
+
+    void enumerate();
+
+    Operator* build(uint64_t set, vector<Input*>& scanned);
+
+    string toString(uint64_t set) const;
+
+public:
+    /// Lookups in a hash table or an index, counted in tuples produced
+    static constexpr double probeCost = 2;
+
+    /// Dynamic programming keeps a plan for every subset
+    static const size_t maxInputs = 16;
+
+    /// Values of the parameters of the query being planned by their index, set by the caller before planning.
+    /// The plan is shared by all executions of the query, so it is estimated for the constants of the first one.
+    /// Parameters without a value, like those of a prepared statement, are estimated by guesses.
+    static vector<string> parameterValues;
+
+    JoinOrder(vector<Input>& inputs);
+
+    /// Record the join conditions between the inputs i and j, the IU of i first
+    void addConditions(size_t i, size_t j, const vector<tuple<IU*, IU*>>& conditions);
+
+    /// Find the cheapest plan and create its joins. The inputs that are scanned as a whole are added to scanned
+    Operator* build(vector<Input*>& scanned);
+
+    /// The chosen plan with its estimated rows, like ((order [15000] JOIN orderline [149711]) [149711])
+    string toString() const;
+
+    /// Estimated number of rows of a relation, at least 1
+    static double rowCount(const Schema::Relation& relation);
+
+    /// Fraction of the rows of a relation that match its selections
+    static double selectivity(const Schema::Relation& relation, const selectionType& selections);
+
+    /// Fraction of the pairs of tuples of two relations that match the join conditions between them,
+    /// after the selections on both relations
+    static double joinSelectivity(const vector<tuple<IU*, IU*>>& conditions, const selectionType& left, const selectionType& right);
+};
+
+
+#endif //TASK5_JOINORDER_H
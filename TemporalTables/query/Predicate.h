@@ -0,0 +1,74 @@
+#ifndef TASK5_PREDICATE_H
+#define TASK5_PREDICATE_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+/// The comparison of a selection, BETWEEN is a GreaterEqual and a LessEqual selection,
+/// an OR of equalities on one column is an In selection
+enum class CompareOp {
+    Equal, Like, NotEqual, Less, LessEqual, Greater, GreaterEqual, In
+};
+
+/// Right hand side of a selection, a value of "?" is a parameter
+struct Predicate {
+    CompareOp op = CompareOp::Equal;
+    std::string value;
+    /// Index of the parameter in the params of the query, numbered in the order of the query, -1 for a constant
+    int param = -1;
+    /// Elements of an IN list like value and param, value is unused
+    std::vector<std::string> values;
+    std::vector<int> params;
+
+    Predicate() = default;
+    explicit Predicate(CompareOp op, std::string value = "", int param = -1)
+            : op(op), value(std::move(value)), param(param) {}
+    /// An IN list
+    Predicate(std::vector<std::string> values, std::vector<int> params)
+            : op(CompareOp::In), values(std::move(values)), params(std::move(params)) {}
+};
+
+/// A comparison that bounds the values of the column from below or from above
+inline bool isRange(CompareOp op) {
+    return op == CompareOp::Less || op == CompareOp::LessEqual || op == CompareOp::Greater || op == CompareOp::GreaterEqual;
+}
+
+/// The operator of the generated code for a comparison, LIKE has none
+inline const char* compareOperator(CompareOp op) {
+    switch (op) {
+        case CompareOp::NotEqual:
+            return "!=";
+        case CompareOp::Less:
+            return "<";
+        case CompareOp::LessEqual:
+            return "<=";
+        case CompareOp::Greater:
+            return ">";
+        case CompareOp::GreaterEqual:
+            return ">=";
+        default:
+            return "==";
+    }
+}
+
+inline std::ostream& operator<<(std::ostream& out, const Predicate& p) {
+    switch (p.op) {
+        case CompareOp::Like:
+            return out << " LIKE " << p.value;
+        case CompareOp::Equal:
+            return out << "=" << p.value;
+        case CompareOp::NotEqual:
+            return out << "<>" << p.value;
+        case CompareOp::In:
+            out << " IN (";
+            for (size_t i = 0; i < p.values.size(); i++) {
+                out << (i > 0 ? ", " : "") << p.values[i];
+            }
+            return out << ")";
+        default:
+            return out << compareOperator(p.op) << p.value;
+    }
+}
+
+#endif //TASK5_PREDICATE_H
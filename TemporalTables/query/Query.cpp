@@ -1 +1,57 @@
 #include "Query.h"
+
+/// Representative of the equivalence class of a column, with path compression
+static string findClass(map<string, string>& parent, const string& column) {
+    auto it = parent.find(column);
+    if (it == parent.end()) {
+        return parent[column] = column;
+    }
+    if (it->second == column) {
+        return column;
+    }
+    return it->second = findClass(parent, it->second);
+}
+
+void Query::deriveSelections() {
+    //Union-find over the columns of the join conditions
+    map<string, string> parent;
+    for (auto& condition : joinConditions) {
+        const string left = findClass(parent, condition.first), right = findClass(parent, condition.second);
+        if (left != right) {
+            parent[left] = right;
+        }
+    }
+
+    //Constants and parameters of every class, with the comparison, a range of one column is a range of all
+    auto same = [](const Predicate& a, const Predicate& b) {
+        return a.op == b.op && a.value == b.value && a.param == b.param && a.values == b.values && a.params == b.params;
+    };
+    map<string, vector<Predicate>> constants;
+    for (auto& s : selection) {
+        if (s.second.op != CompareOp::Like && parent.count(s.first)) {
+            auto& values = constants[findClass(parent, s.first)];
+            if (find_if(values.begin(), values.end(), [&](const Predicate& p) { return same(p, s.second); }) == values.end()) {
+                values.push_back(s.second);
+            }
+        }
+    }
+
+    vector<string> columns;
+    for (auto& p : parent) {
+        columns.push_back(p.first);
+    }
+    for (auto& column : columns) {
+        auto values = constants.find(findClass(parent, column));
+        if (values == constants.end()) {
+            continue;
+        }
+        for (auto& value : values->second) {
+            auto existing = find_if(selection.begin(), selection.end(), [&](const pair<string, Predicate>& s) {
+                return s.first == column && same(s.second, value);
+            });
+            if (existing == selection.end()) {
+                selection.emplace_back(column, value);
+            }
+        }
+    }
+}
@@ -11,12 +11,17 @@
 #include <algorithm>
 #include <stack>
 #include <memory>
+#include <map>
 
 #include "../parser/Schema.hpp"
 #include "../parser/IU.h"
+#include "Predicate.h"
 
 using conditionType = pair<string, string>;
-using selectionType = vector<pair<IU*, string>>;
+
+class Interpreter;
+
+using selectionType = vector<pair<IU*, Predicate>>;
 
 class Query {
     friend class SQLParser;
@@ -24,9 +29,11 @@ class Query {
     bool explain = false;
 
 protected:
-    vector<conditionType> selection;
+    /// EXPLAIN ANALYZE: execute the query with counters in every operator and print the plan with them
+    bool analyze = false;
+
+    vector<pair<string, Predicate>> selection;
     vector<conditionType> joinConditions;
-    int questionMarksReserved = 0;
 
     selectionType getSelections(Operator* op) {
         selectionType conditions;
@@ -64,6 +71,10 @@ protected:
         return conditions;
     }
 
+    /// Add the selections implied by the join conditions: the columns joined with each other directly or transitively
+    /// form an equivalence class, and a comparison with a constant that holds for one of them holds for all of them
+    void deriveSelections();
+
 public:
     virtual ~Query() { }
 
@@ -71,9 +82,17 @@ public:
 
     virtual string generateQueryCode() = 0;
 
+    /// Run the query with the interpreter instead of compiling it. Returns false without running anything if the
+    /// interpreter does not support its plan.
+    virtual bool interpret(Interpreter&) { return false; }
+
     bool shouldExplain() {
         return explain;
     }
+
+    bool shouldAnalyze() {
+        return analyze;
+    }
 };
 
 
@@ -2,11 +2,16 @@
 
 
 #include "Select.h"
+#include "JoinOrder.h"
 #include "../operators/TableScan.h"
 #include "../operators/Selection.h"
-#include "../operators/HashJoin.h"
+#include "../operators/IndexScan.h"
+#include "../operators/Aggregate.h"
+#include "../operators/Sort.h"
 #include "../parser/ParserError.h"
 #include "../operators/Print.h"
+#include "../interpreter/Interpreter.h"
+#include <boost/algorithm/string/replace.hpp>
 
 using namespace std;
 
@@ -23,22 +28,46 @@ string QuerySelect::toString() const {
     }
     out << endl << "WHERE: \n\t SEL: ";
     for (auto& e : this->selection) {
-        out << get<0>(e) << "=" << get<1>(e) << " ";
+        out << get<0>(e) << get<1>(e) << " ";
     }
     out << "\n\t JOI: ";
     for (auto& e : this->joinConditions) {
         out << get<0>(e) << "=" << get<1>(e) << " ";
     }
+    if (!aggregates.empty() || !groupBy.empty()) {
+        out << endl << "AGGREGATE: ";
+        for (auto& e : this->aggregates) {
+            out << e << " ";
+        }
+        out << endl << "GROUP BY: ";
+        for (auto& e : this->groupBy) {
+            out << e << " ";
+        }
+    }
+    if (!orderBy.empty() || limit >= 0) {
+        out << endl << "ORDER BY: ";
+        for (auto& e : this->orderBy) {
+            out << e.first << (e.second ? " DESC " : " ");
+        }
+        out << "LIMIT: " << limit;
+    }
 
     return out.str();
 }
 
-string QuerySelect::generateQueryCode() {
+QuerySelect::Plan::~Plan() {
+    sort.reset();
+    aggregate.reset();
+    delete tree;
+}
+
+void QuerySelect::plan(Plan& plan) {
+    //Constant selections also hold for all columns joined with the selected one
+    deriveSelections();
 
     //Generate all tablescans with selections
-    stack<Operator*> ops;
+    vector<JoinOrder::Input> inputs;
     for (auto r : relations) {
-        //for (auto i = relations.size(); i > 0; i--) {
         auto& relationSchema = schema->findRelation(r);
         auto ts = new TableScan(relationSchema);
         auto selectionConditions = getSelections(ts);
@@ -46,41 +75,98 @@ string QuerySelect::generateQueryCode() {
         //If we got matching selections, why not directly add them with a selection
         //If table is under versioning we want to only show most current elements
         if (selectionConditions.size() > 0 || relationSchema.systemVersioning) {
-            ops.push(new Selection(shared_ptr<TableScan>(ts), selectionConditions, sysTimeStart, sysTimeEnd));
+            //Only visit the rows matching the key if the equality selections cover a key prefix or the first column
+            //after it is in a range
+            shared_ptr<TableScan> scan(ts);
+            shared_ptr<Operator> input = scan;
+            auto access = IndexScan::findIndex(relationSchema, IndexScan::selectionValues(selectionConditions), {},
+                                               IndexScan::selectionRanges(selectionConditions),
+                                               IndexScan::selectionLists(selectionConditions));
+            if (access.valid()) {
+                input = make_shared<IndexScan>(scan, access);
+            }
+            auto selection = new Selection(input, selectionConditions, sysTimeStart, sysTimeEnd);
+            inputs.push_back({ts, selection, selectionConditions, access.valid()});
         } else {
-            ops.push(ts);
+            inputs.push_back({ts, ts, selectionConditions, false});
         }
     }
 
-    //Create some hashjoins
-    while (ops.size() >= 2) {
-        auto left = ops.top();
-        ops.pop();
-        auto right = ops.top();
-        ops.pop();
-
-        //Check that there are join conditions and we are not doing a cross join
-        auto conditions = getJoinConditions(left, right);
-        if (conditions.size() == 0) {
-            throw ParserError(0, "No join condition, hash join not possible.");
+    //Choose the join order and build sides by the estimated cost, probing an index where it is cheaper than a hash join
+    JoinOrder order(inputs);
+    for (size_t i = 0; i < inputs.size(); i++) {
+        for (size_t j = i + 1; j < inputs.size(); j++) {
+            order.addConditions(i, j, getJoinConditions(inputs[i].op, inputs[j].op));
+        }
+    }
+    vector<JoinOrder::Input*> scanned;
+    Operator* tree = plan.tree = order.build(scanned);
+    plan.joinOrder = order.toString();
+
+    //Only relations that are actually scanned can evaluate a string condition in the scan, not index scans
+    for (auto input : scanned) {
+        if (auto selection = dynamic_cast<Selection*>(input->op)) {
+            selection->pushDownFilter();
         }
+    }
 
-        //Add a new hashjoin of the two elements
-        ops.push(new HashJoin(*left, *right, conditions));
+    //Aggregate the result of the joins
+    auto& aggregate = plan.aggregate;
+    Operator*& top = plan.top = tree;
+    if (!aggregates.empty() || !groupBy.empty()) {
+        if (projectAll) {
+            throw ParserError(0, "SELECT * cannot be combined with aggregates or GROUP BY.");
+        }
+        vector<IU*> groupIUs;
+        for (auto& column : groupBy) {
+            auto& produced = tree->getProduced();
+            auto iu = find_if(produced.begin(), produced.end(), [&](IU* iu) { return iu->attr->name == column; });
+            if (iu == produced.end()) {
+                throw ParserError(0, "The GROUP BY column " + column + " was not found.");
+            }
+            groupIUs.push_back(*iu);
+        }
+        for (auto& p : projection) {
+            if (find(groupBy.begin(), groupBy.end(), p) == groupBy.end()) {
+                throw ParserError(0, "The column " + p + " has to be in the GROUP BY clause.");
+            }
+        }
+        aggregate.reset(new Aggregate(*tree, groupIUs, aggregates));
+        top = aggregate.get();
+    }
+
+    //Sort the result and apply the limit
+    auto& sort = plan.sort;
+    if (!orderBy.empty() || limit >= 0) {
+        vector<Sort::Key> keys;
+        for (auto& column : orderBy) {
+            auto& produced = top->getProduced();
+            auto iu = find_if(produced.begin(), produced.end(), [&](IU* iu) { return iu->attr->name == column.first; });
+            if (iu == produced.end()) {
+                throw ParserError(0, "The ORDER BY column " + column.first + " was not found.");
+            }
+            keys.emplace_back(*iu, column.second);
+        }
+        sort.reset(new Sort(*top, keys, limit));
+        top = sort.get();
     }
 
     //All the vars we want to output need to be passed to the printer
-    auto projections = vector<IU*>();
+    auto& projections = plan.projections;
     if (projectAll) { // Show all columns
-        for (auto& iu : ops.top()->getProduced()) {
+        for (auto& iu : tree->getProduced()) {
             projections.push_back(iu);
         }
     } else { // Only show a few columns
-        projections.reserve(projection.size());
+        auto columns = projection;
+        for (auto& a : aggregates) {
+            columns.push_back(a.name);
+        }
+        projections.reserve(columns.size());
         bool found;
-        for (auto& p : projection) {
+        for (auto& p : columns) {
             found = false;
-            for (auto& iu : ops.top()->getProduced()) {
+            for (auto& iu : top->getProduced()) {
                 if (iu->attr->name == p || projectAll) {
                     projections.emplace_back(iu);
                     found = true;
@@ -93,17 +179,51 @@ string QuerySelect::generateQueryCode() {
             }
         }
     }
+}
+
+string QuerySelect::generateQueryCode() {
+    Plan operators;
+    plan(operators);
+    Operator* top = operators.top;
 
     //Create a printer that will output our projections
-    Print result = Print(*ops.top(), projections);
-    string ret = result.produce();
-
-    //Free memory
-    while (ops.size() > 0) {
-        auto e = ops.top();
-        delete e;
-        ops.pop();
+    Print result = Print(*top, operators.projections);
+    string ret = "// Join order: " + operators.joinOrder + "\n";
+    if (!shouldAnalyze()) {
+        ret += result.produce();
+    } else {
+        //Count in every operator, then print the plan with the counters after the result
+        vector<pair<string, unsigned>> plan;
+        top->analyze(plan);
+        stringstream out;
+        out << "QueryProfile profile(" << plan.size() << ");" << endl;
+        out << result.produce();
+        out << "if (output) {" << endl;
+        out << "std::cout << std::endl << \"Join order: " << operators.joinOrder << "\" << std::endl;" << endl;
+        out << "profile.print({" << endl;
+        for (auto& line : plan) {
+            string description = line.first;
+            boost::replace_all(description, "\\", "\\\\");
+            boost::replace_all(description, "\"", "\\\"");
+            out << "{\"" << description << "\", " << line.second << "}," << endl;
+        }
+        out << "});" << endl;
+        out << "}" << endl;
+        ret += out.str();
     }
 
     return ret;
 }
+
+bool QuerySelect::interpret(Interpreter& interpreter) {
+    if (shouldExplain() || shouldAnalyze()) {
+        return false;
+    }
+    Plan operators;
+    plan(operators);
+    if (operators.aggregate || operators.sort) {
+        return false;
+    }
+    Print result(*operators.top, operators.projections);
+    return interpreter.run(result);
+}
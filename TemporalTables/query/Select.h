@@ -2,16 +2,25 @@
 #define QUERYSELECT_H
 
 #include "Query.h"
+#include "Aggregation.h"
 #include "../utils/Types.hpp"
 
 using namespace std;
 
+class Aggregate;
+class Sort;
 
 class QuerySelect : public Query {
     friend class SQLParser;
 
     vector<string> projection;
     vector<string> relations;
+    vector<AggregateItem> aggregates;
+    vector<string> groupBy;
+    /// Columns to sort by, true if descending
+    vector<pair<string, bool>> orderBy;
+    /// Number of rows to output, -1 for all
+    long limit = -1;
 
     bool projectAll = false;
     Timestamp sysTimeStart = Timestamp::null();
@@ -19,6 +28,21 @@ class QuerySelect : public Query {
 
     Schema* schema;
 
+    /// The operators of a plan, the Print on top is created by the caller
+    struct Plan {
+        Operator* tree = nullptr;
+        unique_ptr<Aggregate> aggregate;
+        unique_ptr<Sort> sort;
+        Operator* top = nullptr;
+        vector<IU*> projections;
+        string joinOrder;
+
+        ~Plan();
+    };
+
+    /// Choose the join order and add the aggregation, the sort and the projected columns
+    void plan(Plan& plan);
+
 public:
     QuerySelect(Schema* s) : schema(s) { }
 
@@ -27,6 +51,8 @@ public:
     virtual string toString() const;
 
     virtual string generateQueryCode();
+
+    virtual bool interpret(Interpreter& interpreter);
 };
 
 
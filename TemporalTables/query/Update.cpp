@@ -1,5 +1,6 @@
 
 #include "Update.h"
+#include "../interpreter/Interpreter.h"
 
 
 using namespace std;
@@ -14,7 +15,7 @@ string QueryUpdate::toString() const {
     }
     out << endl << "WHERE: \n\t ";
     for (auto& e : this->selection) {
-        out << get<0>(e) << "=" << get<1>(e) << " ";
+        out << get<0>(e) << get<1>(e) << " ";
     }
 
     return out.str();
@@ -37,25 +38,38 @@ vector<fieldType> QueryUpdate::getFields(Operator* sel) {
     return conditions;
 }
 
-string QueryUpdate::generateQueryCode() {
-    ostringstream out;
-
-    Operator* finder;
-    auto rel = schema->findRelation(relation);
+Operator* QueryUpdate::finder(Schema::Relation& rel, selectionType& selectionConditions) {
     auto ts = new TableScan(rel);
-    auto selectionConditions = getSelections(ts);
+    selectionConditions = getSelections(ts);
 
     if (selectionConditions.size() > 0) {
         auto n = Timestamp::null();
-        finder = new Selection(shared_ptr<TableScan>(ts), selectionConditions, n, n, questionMarksReserved);
-    } else {
-        finder = ts;
+        return new Selection(shared_ptr<TableScan>(ts), selectionConditions, n, n);
     }
+    return ts;
+}
+
+string QueryUpdate::generateQueryCode() {
+    ostringstream out;
+
+    auto rel = schema->findRelation(relation);
+    selectionType selectionConditions;
+    Operator* finder = this->finder(rel, selectionConditions);
     vector<fieldType> fields = getFields(finder);
-    Update* u = new Update(*finder, fields, rel, selectionConditions, questionMarksReserved);
+    Update* u = new Update(*finder, fields, rel, selectionConditions);
     out << u->produce();
 
     delete u;
     delete finder;
     return out.str();
 }
+
+bool QueryUpdate::interpret(Interpreter& interpreter) {
+    auto rel = schema->findRelation(relation);
+    selectionType selectionConditions;
+    unique_ptr<Operator> finder(this->finder(rel, selectionConditions));
+    vector<fieldType> fields = getFields(finder.get());
+
+    Update update(*finder, fields, rel, selectionConditions);
+    return interpreter.run(update);
+}
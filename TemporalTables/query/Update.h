@@ -18,6 +18,9 @@ class QueryUpdate : public Query {
 
     vector<fieldType> getFields(Operator*);
 
+    /// The scan with the selections of the rows to update
+    Operator* finder(Schema::Relation& rel, selectionType& selectionConditions);
+
 public:
     QueryUpdate(Schema* s) : schema(s) { }
 
@@ -26,6 +29,8 @@ public:
     virtual string toString() const;
 
     virtual string generateQueryCode();
+
+    virtual bool interpret(Interpreter& interpreter);
 };
 
 
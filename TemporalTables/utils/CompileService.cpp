@@ -0,0 +1,85 @@
+#include "CompileService.h"
+
+using namespace std;
+
+CompileService::CompileService(unsigned workers) : workerCount(workers) {
+    if (workerCount == 0) {
+        workerCount = max(2u, thread::hardware_concurrency());
+    }
+}
+
+CompileService::~CompileService() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+shared_future<long> CompileService::submit(const string& output, Build build, bool urgent, Callback done) {
+    unique_lock<mutex> guard(lock);
+    auto it = inFlight.find(output);
+    if (it != inFlight.end()) {
+        return it->second;
+    }
+
+    //The workers are only started by the first build, programs that never compile have no threads
+    if (workers.empty()) {
+        for (unsigned i = 0; i < workerCount; i++) {
+            workers.emplace_back(&CompileService::work, this);
+        }
+    }
+
+    Request request{output, move(build), move(done), promise<long>()};
+    shared_future<long> result = request.result.get_future().share();
+    inFlight[output] = result;
+    (urgent ? this->urgent : background).push_back(move(request));
+    guard.unlock();
+    //Waiting for all builds uses the same condition, every worker has to see the request
+    changed.notify_all();
+    return result;
+}
+
+void CompileService::work() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        changed.wait(guard, [this]() { return stopping || !urgent.empty() || !background.empty(); });
+        if (urgent.empty() && background.empty()) {
+            return;
+        }
+
+        auto& queue = !urgent.empty() ? urgent : background;
+        Request request = move(queue.front());
+        queue.pop_front();
+        running++;
+        guard.unlock();
+
+        long time = -1;
+        try {
+            time = request.build();
+        } catch (...) {
+        }
+        if (request.done) {
+            request.done(time);
+        }
+
+        guard.lock();
+        inFlight.erase(request.output);
+        running--;
+        request.result.set_value(time);
+        changed.notify_all();
+    }
+}
+
+void CompileService::wait() {
+    unique_lock<mutex> guard(lock);
+    changed.wait(guard, [this]() { return urgent.empty() && background.empty() && running == 0; });
+}
+
+size_t CompileService::pending() const {
+    lock_guard<mutex> guard(lock);
+    return urgent.size() + background.size() + running;
+}
@@ -0,0 +1,68 @@
+#ifndef TASK5_COMPILESERVICE_H
+#define TASK5_COMPILESERVICE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+using namespace std;
+
+/// Runs the builds of generated files on a pool of workers, each running one compiler process at a time, so that the
+/// caller can go on and only waits for the future of a build when it needs it.
+///
+/// A build is identified by the file it produces. Requesting a file that is queued or being built returns the future
+/// of that build instead of building it again. Urgent builds, which somebody waits for, are taken before the others.
+class CompileService {
+public:
+    /// Builds a file, returns the milliseconds it took or -1 if it failed
+    using Build = function<long()>;
+    /// Called by the worker with the result of a build, before its future is ready
+    using Callback = function<void(long)>;
+
+private:
+    struct Request {
+        string output;
+        Build build;
+        Callback done;
+        promise<long> result;
+    };
+
+    mutable mutex lock;
+    condition_variable changed;
+    deque<Request> urgent;
+    deque<Request> background;
+    /// Futures of the builds that are queued or running, by their file
+    map<string, shared_future<long>> inFlight;
+    unsigned running = 0;
+    bool stopping = false;
+
+    unsigned workerCount;
+    vector<thread> workers;
+
+    void work();
+
+public:
+    /// Without a number of workers there is one per core, but at least two so that an urgent build does not have to
+    /// wait for a build in the background on a single core
+    explicit CompileService(unsigned workers = 0);
+
+    /// Finishes the queued builds
+    ~CompileService();
+
+    /// Queue the build of a file, the callback is only run for the request that queued it
+    shared_future<long> submit(const string& output, Build build, bool urgent = false, Callback done = nullptr);
+
+    /// Wait until all builds are done, including the ones queued by callbacks
+    void wait();
+
+    /// Builds that are queued or running
+    size_t pending() const;
+};
+
+#endif //TASK5_COMPILESERVICE_H
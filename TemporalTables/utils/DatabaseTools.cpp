@@ -1,13 +1,34 @@
 
+#include <sys/stat.h>
 #include "DatabaseTools.h"
+#include "../interpreter/Interpreter.h"
+#include "../operators/Operator.h"
+#include "../query/JoinOrder.h"
+#include "PreparedStatement.h"
 
 
-using queryType = void (*)(Database*, vector<string>, bool);
+using queryType = PlanRegistry::QueryFunction;
 const string DatabaseTools::dbName = "db";
+const string DatabaseTools::queryHeader = "query";
 const string DatabaseTools::folderTmp = "tmp/";
 const string DatabaseTools::folderTable = "./tblTemporal/";
 //Debug symbols: -g  -O0 -DDEBUG -ggdb3 / Additional: -flto  -pipe
-const char* DatabaseTools::cmdBuild{"g++ -O3 -std=c++14 -fPIC -flto -pipe %s -shared -o %s\0"};
+const char* DatabaseTools::cmdBuild{"g++ -O3 -march=native -std=c++14 -fPIC -flto -fopenmp -pipe %s -shared -o %s\0"};
+//New queries first run from a build that is quick to compile, until the optimized build is done
+const char* DatabaseTools::cmdBuildFast{"g++ -O1 -march=native -std=c++14 -fPIC -fopenmp -pipe %s -shared -o %s\0"};
+//A precompiled header is only used with the same options as the query
+//Hot queries are compiled again with the profile of their executions, both builds share the name of the profile.
+//Counters updated from several threads may lose increments, the profile is corrected
+const char* DatabaseTools::cmdBuildProfiling{"g++ -O3 -march=native -std=c++14 -fPIC -flto -fopenmp -pipe -fprofile-generate -fprofile-update=prefer-atomic %s -shared -o %s -dumpbase %s\0"};
+const char* DatabaseTools::cmdBuildProfiled{"g++ -O3 -march=native -std=c++14 -fPIC -flto -fopenmp -pipe -fprofile-use -fprofile-correction %s -shared -o %s -dumpbase %s\0"};
+const char* DatabaseTools::cmdHeader{"g++ -O3 -march=native -std=c++14 -fPIC -flto -fopenmp -pipe -x c++-header %s -o %s\0"};
+const char* DatabaseTools::cmdHeaderFast{"g++ -O1 -march=native -std=c++14 -fPIC -fopenmp -pipe -x c++-header %s -o %s\0"};
+PlanRegistry DatabaseTools::plans;
+CompileService DatabaseTools::compiler;
+DatabaseTools::Engine DatabaseTools::engine = Engine::Auto;
+set<string> DatabaseTools::interpreted;
+uint64_t DatabaseTools::profileRuns = 100000;
+set<string> DatabaseTools::profiled;
 
 
 void DatabaseTools::split(const std::string& str, std::vector<std::string>& lineChunks) {
@@ -19,7 +40,7 @@ void DatabaseTools::split(const std::string& str, std::vector<std::string>& line
     }
 }
 
-long DatabaseTools::compileFile(const string name) {
+long DatabaseTools::compileFile(const string name, Tier tier) {
     using namespace std::chrono;
 
     //Start the clock
@@ -27,7 +48,7 @@ long DatabaseTools::compileFile(const string name) {
 
     //Assemble file names
     string fileIn = folderTmp + name + ".cpp";
-    string fileOut = folderTmp + name + ".so";
+    string fileOut = library(name, tier);
 
     //Cache queries on disk
     ifstream f(fileOut);
@@ -35,14 +56,19 @@ long DatabaseTools::compileFile(const string name) {
         return duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
     }
 
-    //Build the command by replacing the anchors / placeholders with the correct values
-    char* command = new char[strlen(cmdBuild) + fileIn.size() + fileOut.size() + 5];
-    sprintf(command, cmdBuild, fileIn.c_str(), fileOut.c_str());
+    //Build the command by replacing the anchors / placeholders with the correct values. The library is renamed once
+    //it is complete, a build in the background is never seen half written
+    const char* cmd = tier == Tier::Fast ? cmdBuildFast : tier == Tier::Profiling ? cmdBuildProfiling
+                                                        : tier == Tier::Profiled ? cmdBuildProfiled : cmdBuild;
+    string filePart = fileOut + ".part";
+    string fileProfile = folderTmp + name;
+    char* command = new char[strlen(cmd) + fileIn.size() + filePart.size() + fileProfile.size() + 5];
+    sprintf(command, cmd, fileIn.c_str(), filePart.c_str(), fileProfile.c_str());
     int ret = system(command);
     delete[] command;
 
     //If compilation failed
-    if (ret != 0) {
+    if (ret != 0 || rename(filePart.c_str(), fileOut.c_str()) != 0) {
         return -1;
     }
 
@@ -50,6 +76,71 @@ long DatabaseTools::compileFile(const string name) {
     return duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
 }
 
+shared_future<long> DatabaseTools::submitFile(const string& name, Tier tier, bool urgent) {
+    return compiler.submit(library(name, tier), [name, tier]() { return compileFile(name, tier); }, urgent);
+}
+
+shared_future<long> DatabaseTools::compileTiered(const string name) {
+    const string optimized = library(name, Tier::Optimized);
+    if (ifstream(optimized).good()) {
+        promise<long> done;
+        done.set_value(0);
+        return done.get_future().share();
+    }
+
+    //Once the fast build is done it runs in place of the optimized one, which is queued behind the urgent builds
+    return compiler.submit(library(name, Tier::Fast), [name]() { return compileFile(name, Tier::Fast); }, true,
+                           [name, optimized](long time) {
+                               if (time < 0 || ifstream(optimized).good()) {
+                                   return;
+                               }
+                               plans.optimizing(optimized, library(name, Tier::Fast));
+                               compiler.submit(optimized, [name]() { return compileFile(name, Tier::Optimized); }, false,
+                                               [optimized](long time) { plans.optimized(optimized, time); });
+                           });
+}
+
+void DatabaseTools::waitForBuilds() {
+    compiler.wait();
+}
+
+string DatabaseTools::library(const string& name, Tier tier) {
+    switch (tier) {
+        case Tier::Fast:
+            return folderTmp + name + ".fast.so";
+        case Tier::Profiling:
+            return folderTmp + name + ".profile.so";
+        case Tier::Profiled:
+            return folderTmp + name + ".pgo.so";
+        default:
+            return folderTmp + name + ".so";
+    }
+}
+
+long DatabaseTools::compileHeader(const string name, Tier tier) {
+    using namespace std::chrono;
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+
+    //The directory holds a precompiled header for every tier, the compiler picks the one matching its options
+    string fileIn = folderTmp + name + ".h";
+    string folderOut = folderTmp + name + ".h.gch/";
+    mkdir(folderOut.c_str(), 0755);
+
+    const char* cmd = tier == Tier::Fast ? cmdHeaderFast : cmdHeader;
+    string fileOut = folderOut + (tier == Tier::Fast ? "fast" : "optimized");
+    char* command = new char[strlen(cmd) + fileIn.size() + fileOut.size() + 5];
+    sprintf(command, cmd, fileIn.c_str(), fileOut.c_str());
+    int ret = system(command);
+    delete[] command;
+
+    //Without the precompiled header the queries parse the header themselves
+    if (ret != 0) {
+        remove(fileOut.c_str());
+        return -1;
+    }
+    return duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+}
+
 Database* DatabaseTools::loadAndRunDb(string filename) {
     void* handle = dlopen((folderTmp + filename).c_str(), RTLD_NOW);
     if (!handle) {
@@ -73,7 +164,118 @@ Database* DatabaseTools::loadAndRunDb(string filename) {
 }
 
 
-long DatabaseTools::loadAndRunQuery(string filename, Database* db, vector<string>& tmp) {
+void* DatabaseTools::databaseLibrary() {
+    static void* handle = nullptr;
+    if (!handle) {
+        handle = dlopen((folderTmp + dbName + ".so").c_str(), RTLD_NOW);
+    }
+    if (!handle) {
+        cerr << "error loading .so: " << dlerror() << endl;
+    }
+    return handle;
+}
+
+/// Add the rows added since the last call to the statistics of a relation, or of all relations if it is empty.
+/// With reset the statistics start over.
+static bool analyzeRelations(Schema* s, Database* db, const string& relation, bool reset) {
+    //This runs after every query
+    void* handle = DatabaseTools::databaseLibrary();
+    if (!handle) {
+        return false;
+    }
+
+    auto analyzeTable = reinterpret_cast<void (*)(Database*, const string&, TableStatistics&)>(dlsym(handle, "analyzeTable"));
+    if (!analyzeTable) {
+        cerr << "error: " << dlerror() << endl;
+    } else {
+        for (auto& r : s->relations) {
+            if (!relation.empty() && r.name != relation) {
+                continue;
+            }
+            if (reset) {
+                r.statistics = TableStatistics();
+            }
+            const uint64_t analyzed = r.statistics.analyzed;
+            analyzeTable(db, r.name, r.statistics);
+
+            //The histograms only change with new rows
+            if (r.statistics.analyzed != analyzed || reset) {
+                for (auto& column : r.statistics.columns) {
+                    column.finish();
+                }
+            }
+        }
+    }
+    return analyzeTable != nullptr;
+}
+
+void DatabaseTools::loadStatistics(Schema* s, Database* db) {
+    analyzeRelations(s, db, "", false);
+}
+
+void DatabaseTools::analyze(Schema* s, Database* db, const string& relation) {
+    if (!relation.empty()) {
+        s->findRelation(relation);
+    }
+    if (!analyzeRelations(s, db, relation, true)) {
+        return;
+    }
+
+    for (auto& r : s->relations) {
+        if (!relation.empty() && r.name != relation) {
+            continue;
+        }
+        cout << r.name << ": " << r.statistics.rows << " rows" << endl;
+        for (size_t i = 0; i < r.statistics.columns.size(); i++) {
+            auto& column = r.statistics.columns[i];
+            cout << "\t" << r.attributes[i].name << ": " << (uint64_t) column.distinct() << " distinct";
+            if (column.count > 0) {
+                cout << ", min " << column.minText << ", max " << column.maxText << ", " << column.bounds.size() - 1 << " buckets";
+            }
+            cout << endl;
+        }
+    }
+}
+
+
+long DatabaseTools::interpretQuery(const string& query, Schema* s, Database* db, Engine engine) {
+    using namespace std::chrono;
+    if (engine == Engine::Compile) {
+        return -1;
+    }
+
+    SQLLexer lexer(query);
+    SQLParser q(lexer, !lexer.hasParameters());
+    unique_ptr<Query> qu(q.parse(s));
+    vector<string> params(q.getConstants());
+
+    //Compiling pays off for a query that is repeated, or that was compiled before
+    const string filename = "query_" + md5(s->version + q.getNormalizedQuery());
+    if (engine == Engine::Auto && (!interpreted.insert(filename).second || ifstream(library(filename)).good()
+                                    || ifstream(library(filename, Tier::Fast)).good())) {
+        return -1;
+    }
+
+    void* handle = databaseLibrary();
+    if (!handle) {
+        return -1;
+    }
+    //The planner finds the types of the parameters like for the generated code, not those of the last query
+    Operator::parameters.clear();
+    JoinOrder::parameterValues = params;
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    try {
+        Interpreter interpreter(db, handle, params);
+        if (!qu->interpret(interpreter)) {
+            return -1;
+        }
+    } catch (char const* msg) {
+        cerr << "Error: " << msg << endl;
+    }
+    return duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+}
+
+long DatabaseTools::loadAndRunQuery(string filename, Database* db, vector<string>& tmp, Tier* tier) {
     using namespace std::chrono;
 
     string filenameExt = folderTmp + filename + ".so";
@@ -81,31 +283,67 @@ long DatabaseTools::loadAndRunQuery(string filename, Database* db, vector<string
     //Start the clock
     high_resolution_clock::time_point start = high_resolution_clock::now();
 
-    //Load up the dynamic lib
-    void* handle = dlopen(filenameExt.c_str(), RTLD_NOW);
-    if (!handle) {
-        cerr << "error loading " << filenameExt << ": " << dlerror() << endl;
+    //Get the function pointer, the library is only loaded the first time
+    Tier ran;
+    uint64_t runs;
+    auto query = plans.get(filenameExt, &ran, &runs);
+    if (!query) {
         return 0;
     }
+    if (tier) {
+        *tier = ran;
+    }
 
-    //Get the function pointer
-    auto query = reinterpret_cast<queryType>(dlsym(handle, "query"));
-    if (!query) {
-        cerr << "error: " << dlerror() << endl;
-        return 0;
+    //Execute, invalid values of parameters are only found when they are cast
+    try {
+        query(db, tmp, true);
+    } catch (char const* msg) {
+        cerr << "Error: " << msg << endl;
     }
 
-    //Execute
-    query(db, tmp, true);
+    //Stop an return the execution time
+    const long time = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+    recompileHot(filename, ran, runs);
+    return time;
+}
 
-    //Unload
-    if (dlclose(handle)) {
-        cerr << "error: " << dlerror() << endl;
-        return 0;
+void DatabaseTools::runQuery(const string& filename, Database* db, vector<string>& params) {
+    Tier tier;
+    uint64_t runs;
+    auto query = plans.get(library(filename), &tier, &runs);
+    if (!query) {
+        throw "Compiled query not found";
     }
+    query(db, params, false);
+    recompileHot(filename, tier, runs);
+}
 
-    //Stop an return the execution time
-    return duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+void DatabaseTools::recompileHot(const string& filename, Tier tier, uint64_t runs) {
+    if (runs != profileRuns) {
+        return;
+    }
+    const string optimized = library(filename);
+
+    if (tier == Tier::Optimized && profiled.insert(filename).second) {
+        //The build collecting the profile runs in place of the optimized one once it is compiled
+        const string profiling = library(filename, Tier::Profiling);
+        compiler.submit(profiling, [filename]() { return compileFile(filename, Tier::Profiling); }, false,
+                        [optimized, profiling](long time) {
+                            if (time >= 0) {
+                                plans.replace(optimized, profiling, Tier::Profiling);
+                            }
+                        });
+    } else if (tier == Tier::Profiling) {
+        //Unloading the profiling build writes the profile, the optimized build runs until the profiled one is compiled
+        plans.restore(optimized);
+        const string profiled = library(filename, Tier::Profiled);
+        compiler.submit(profiled, [filename]() { return compileFile(filename, Tier::Profiled); }, false,
+                        [optimized, profiled](long time) {
+                            if (time >= 0) {
+                                plans.replace(optimized, profiled, Tier::Profiled);
+                            }
+                        });
+    }
 }
 
 Schema* DatabaseTools::parseAndWriteSchema(const string& schemaFile) {
@@ -115,13 +353,47 @@ Schema* DatabaseTools::parseAndWriteSchema(const string& schemaFile) {
         schema = p.parse();
         cout << "Loaded " << schema->relations.size() << " relations into our schema." << endl;
 
-        //Write to file the database
+        //Write to file the database, the queries only include its header
+        const string header = schema->generateDatabaseHeader();
+        const string code = schema->generateDatabaseCode(dbName + ".h");
+        schema->version = md5(header + code);
         ofstream myfile;
+        myfile.open(folderTmp + dbName + ".h");
+        myfile << header;
+        myfile.close();
         myfile.open(folderTmp + dbName + ".cpp");
-        myfile << schema->generateDatabaseCode();
+        myfile << code;
         myfile.close();
 
-        compileFile(dbName);
+        auto database = submitFile(dbName, Tier::Optimized, true);
+
+        //Everything the queries include is parsed once into a precompiled header, while the database is compiled
+        myfile.open(folderTmp + queryHeader + ".h");
+        myfile << "#include <string>" << endl
+               << "#include <map>" << endl
+               << "#include <iostream>" << endl
+               << "#include <tuple>" << endl
+               << "#include <array>" << endl
+               << "#include <algorithm>" << endl
+               << "#include <parallel/algorithm>" << endl
+               << "#include <iomanip>" << endl
+               << "#include \"" << dbName << ".h\"" << endl
+               << "#include \"../utils/Types.hpp\"" << endl
+               << "#include \"../utils/HashJoinTable.h\"" << endl
+               << "#include \"../utils/HashAggregationTable.h\"" << endl
+               << "#include \"../utils/ValueSet.h\"" << endl
+               << "#include \"../utils/QueryProfile.h\"" << endl
+               << "#include \"../utils/ParameterLayout.h\"" << endl;
+        myfile.close();
+        vector<shared_future<long>> headers;
+        for (auto tier : {Tier::Fast, Tier::Optimized}) {
+            headers.push_back(compiler.submit(folderTmp + queryHeader + ".h.gch/" + (tier == Tier::Fast ? "fast" : "optimized"),
+                                              [tier]() { return compileHeader(queryHeader, tier); }, true));
+        }
+        database.wait();
+        for (auto& header : headers) {
+            header.wait();
+        }
     } catch (ParserError& e) {
         cerr << e.what() << " on line " << e.where() << endl;
     } catch (char const* msg) {
@@ -133,44 +405,100 @@ Schema* DatabaseTools::parseAndWriteSchema(const string& schemaFile) {
 }
 
 string DatabaseTools::parseAndWriteQuery(const string& query, Schema* s) {
-    string filename = "query_" + md5(query);
+    vector<string> params;
+    return parseAndWriteQuery(query, s, params);
+}
+
+string DatabaseTools::parseAndWriteQuery(const string& query, Schema* s, vector<string>& params) {
+    //Queries with question marks are prepared by the caller, which numbers their parameters
+    SQLLexer lexer(query);
+    SQLParser q(lexer, !lexer.hasParameters());
+    Query* qu = q.parse(s);
+    params.insert(params.end(), q.getConstants().begin(), q.getConstants().end());
+
+    string filename = "query_" + md5(s->version + q.getNormalizedQuery());
     ifstream f(folderTmp + filename + ".so");
-    if (f.good()) { // Only compile if not already on disk
+    ifstream code(folderTmp + filename + ".cpp");
+    if (f.good() || code.good()) { // Only compile if not already on disk, or being compiled from the code on disk
+        delete qu;
         return filename;
     }
 
-    SQLLexer lexer(query);
-    SQLParser q(lexer);
-    Query* qu = q.parse(s);
+    //The operators collect the types of the parameters they read, the planner estimates the constants of this query
+    Operator::parameters.clear();
+    Operator::prologue.clear();
+    JoinOrder::parameterValues = q.getConstants();
+    string body = qu->generateQueryCode();
+    body.insert(0, Operator::prologue);
+    const map<int, string> parameters = Operator::parameters;
+    const int count = parameters.empty() ? 0 : parameters.rbegin()->first + 1;
 
     ofstream myfile;
     myfile.open(folderTmp + filename + ".cpp");
-    myfile << "#include <string>" << endl;
-    myfile << "#include <map>" << endl;
-    myfile << "#include <iostream>" << endl;
-    myfile << "#include <tuple>" << endl
-           << "#include \"db.cpp\"" << endl
-           << "#include \"../utils/Types.hpp\"" << endl
-           << "#include <algorithm>" << endl
-           << "#include <iomanip>" << endl;
+    //The precompiled header has to come first
+    myfile << "#include \"" << queryHeader << ".h\"" << endl;
     myfile << "using namespace std;" << endl;
     myfile << "/* ";
-    myfile << qu->toString();
+    //A constant of the query must not end the comment
+    myfile << boost::replace_all_copy(qu->toString(), "*/", "* /");
     myfile << " */ " << endl;
-    myfile << "extern \"C\" void query(Database* db, const vector<string>& params, bool output) {" << endl;
+
+    //The parameters in the types they are read in, see ParameterLayout
+    myfile << "struct Parameters {" << endl;
+    for (auto& p : parameters) {
+        myfile << p.second << " p" << p.first << ";" << endl;
+    }
+    myfile << "};" << endl;
+
+    myfile << "static void run(Database* db, const Parameters& params, bool output) {" << endl;
     if (qu->shouldExplain()) {
         //Replace special characters
-        string code = qu->generateQueryCode();
-        boost::replace_all(code, "\"", "\\\"");
-        boost::replace_all(code, "\n", "\\n");
+        boost::replace_all(body, "\"", "\\\"");
+        boost::replace_all(body, "\n", "\\n");
 
         myfile << "cout << \"";
-        myfile << code << "\";" << endl << endl;
+        myfile << body << "\";" << endl << endl;
     } else {
-        myfile << qu->generateQueryCode();
+        myfile << body;
+    }
+    myfile << "}" << endl;
+
+    //The console passes strings, they are all cast before the query changes anything
+    myfile << "extern \"C\" void query(Database* db, const vector<string>& values, bool output) {" << endl;
+    myfile << "if (values.size() < " << count << ") { throw \"Missing parameters\"; }" << endl;
+    myfile << "Parameters params;" << endl;
+    for (auto& p : parameters) {
+        const string value = "values[" + to_string(p.first) + "]";
+        myfile << "params.p" << p.first << " = ";
+        if (p.second == "Pattern") {
+            myfile << "Pattern{" << value << ".c_str(), (uint32_t) " << value << ".size()};" << endl;
+        } else {
+            myfile << p.second << "::castString(" << value << ".c_str(), " << value << ".size());" << endl;
+        }
     }
+    myfile << "run(db, params, output);" << endl;
+    myfile << "}" << endl;
+
+    myfile << "extern \"C\" void queryBound(Database* db, const void* params, bool output) {" << endl;
+    myfile << "run(db, *static_cast<const Parameters*>(params), output);" << endl;
+    myfile << "}" << endl;
+
+    myfile << "extern \"C\" const ParameterLayout* parameterLayout() {" << endl;
+    myfile << "static const ParameterLayout layout{sizeof(Parameters), alignof(Parameters), {";
+    for (int i = 0; i < count; i++) {
+        auto p = parameters.find(i);
+        if (p != parameters.end()) {
+            myfile << "{\"" << p->second << "\", offsetof(Parameters, p" << i << ")}";
+        } else {
+            myfile << "{\"\", 0}";
+        }
+        myfile << (i + 1 < count ? ", " : "");
+    }
+    myfile << "}};" << endl;
+    myfile << "return &layout;" << endl;
     myfile << "}";
     myfile.close();
+    delete qu;
 
     return filename;
 }
@@ -188,130 +516,101 @@ void genRandom(string& str, size_t length) {
     generate_n(str.begin(), length, randChar);
 }
 
+template<unsigned maxLen>
+void genRandom(Varchar<maxLen>& str, size_t length) {
+    str.len = length;
+    generate_n(str.begin(), length, randChar);
+}
+
 void DatabaseTools::performanceTest(Schema* s, Database* db) {
     using namespace std::chrono;
 
     int iterationsInsert = 4000000;
     int iterationsUpdate = 4000000;
     long time = 0, timeTemporal;
-    vector<string> params{"", ""};
 
     cout << "Testing performance - this may take some time (" << iterationsInsert << " iterations)" << endl;
     cout << "compiling queries first";
-    //Load all queries
-    string queriesTemporal[3], queriesNormal[3];
-
-    {
-#pragma omp parallel sections
-        {
-#pragma omp section
-            {
-                queriesTemporal[0] = DatabaseTools::parseAndWriteQuery("INSERT INTO warehouse (w_id, w_city) VALUES (?,?)", s);
-                DatabaseTools::compileFile(queriesTemporal[0]);
-            }
-#pragma omp section
-            {
-                queriesTemporal[1] = DatabaseTools::parseAndWriteQuery("UPDATE warehouse SET w_city=? WHERE w_id=?", s);
-                DatabaseTools::compileFile(queriesTemporal[1]);
-            }
-#pragma omp section
-            {
-                queriesTemporal[2] = DatabaseTools::parseAndWriteQuery("DELETE FROM warehouse WHERE w_id=?", s);
-                DatabaseTools::compileFile(queriesTemporal[2]);
-            }
-#pragma omp section
-            {
-                queriesNormal[0] = DatabaseTools::parseAndWriteQuery("INSERT INTO warehouseold (w_id, w_city) VALUES (?,?)", s);
-                DatabaseTools::compileFile(queriesNormal[0]);
-            }
-#pragma omp section
-            {
-                queriesNormal[1] = DatabaseTools::parseAndWriteQuery("UPDATE warehouseold SET w_city=? WHERE w_id=?", s);
-                DatabaseTools::compileFile(queriesNormal[1]);
-            }
-
-#pragma omp section
-            {
-                queriesNormal[2] = DatabaseTools::parseAndWriteQuery("DELETE FROM warehouseold WHERE w_id=?", s);
-                DatabaseTools::compileFile(queriesNormal[2]);
-            }
-        }
+    //The statements are compiled in parallel on the workers of the compiler
+    PreparedStatement insertTemporal("INSERT INTO warehouse (w_id, w_city) VALUES (?,?)", s);
+    PreparedStatement updateTemporal("UPDATE warehouse SET w_city=? WHERE w_id=?", s);
+    PreparedStatement deleteTemporal("DELETE FROM warehouse WHERE w_id=?", s);
+    PreparedStatement insertNormal("INSERT INTO warehouseold (w_id, w_city) VALUES (?,?)", s);
+    PreparedStatement updateNormal("UPDATE warehouseold SET w_city=? WHERE w_id=?", s);
+    PreparedStatement deleteNormal("DELETE FROM warehouseold WHERE w_id=?", s);
+    for (auto statement : {&insertTemporal, &updateTemporal, &deleteTemporal, &insertNormal, &updateNormal, &deleteNormal}) {
+        statement->wait();
     }
     cout << ": done." << endl;
 
-    {
+    //The values are bound in the types of the columns, w_city is a varchar(20)
+    try {
         //Inserts Temporal
         {
-            string filenameExt = folderTmp + queriesTemporal[0] + ".so";
-            void* handle = dlopen(filenameExt.c_str(), RTLD_NOW);
+            Integer& id = insertTemporal.parameter<Integer>(0);
+            Varchar<20>& city = insertTemporal.parameter<Varchar<20>>(1);
             high_resolution_clock::time_point start = high_resolution_clock::now();
-            auto query = reinterpret_cast<queryType>(dlsym(handle, "query"));
 
             for (int i = 6; i < iterationsInsert; i++) {
-                params[0] = to_string(i);
-                genRandom(params[1], 10);
-                query(db, params, false);
+                id.value = i;
+                genRandom(city, 10);
+                insertTemporal.execute(db);
             }
 
-            dlclose(handle);
             timeTemporal = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
             cout << "Insert - Temporal: " << timeTemporal << "ms (" << (iterationsInsert / (timeTemporal / 1000.0)) / 1000.0 << " kO/s )";
         }
 
         //Inserts Normal
         {
-            string filenameExt = folderTmp + queriesNormal[0] + ".so";
-            void* handle = dlopen(filenameExt.c_str(), RTLD_NOW);
+            Integer& id = insertNormal.parameter<Integer>(0);
+            Varchar<20>& city = insertNormal.parameter<Varchar<20>>(1);
             high_resolution_clock::time_point start = high_resolution_clock::now();
-            auto query = reinterpret_cast<queryType>(dlsym(handle, "query"));
 
             for (int i = 6; i < iterationsInsert; i++) {
-                params[0] = to_string(i);
-                genRandom(params[1], 10);
-                query(db, params, false);
+                id.value = i;
+                genRandom(city, 10);
+                insertNormal.execute(db);
             }
 
-            dlclose(handle);
             time = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
             cout << " / Normal: " << time << "ms (" << (iterationsInsert / (time / 1000.0)) / 1000.0 << " kO/s )";
         }
         cout << " / " << (100.0 - (double) time / (double) timeTemporal * 100.0) << "% slower" << endl;
+    } catch (const char* e) {
+        cout << e << endl;
     }
 
     //Updates
     try {
         //Temporal
         {
-            string filenameExt = folderTmp + queriesTemporal[1] + ".so";
-            void* handle = dlopen(filenameExt.c_str(), RTLD_NOW);
+            Varchar<20>& city = updateTemporal.parameter<Varchar<20>>(0);
+            Integer& id = updateTemporal.parameter<Integer>(1);
             high_resolution_clock::time_point start = high_resolution_clock::now();
-            auto query = reinterpret_cast<queryType>(dlsym(handle, "query"));
 
             for (int i = 6; i < iterationsUpdate; i++) {
-                genRandom(params[0], 10);
-                params[1] = to_string(i);
-                query(db, params, false);
+                genRandom(city, 10);
+                id.value = i;
+                updateTemporal.execute(db);
             }
 
-            dlclose(handle);
             timeTemporal = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
             cout << "Update - Temporal: " << timeTemporal << "ms (" << (iterationsUpdate / (timeTemporal / 1000.0)) / 1000.0 << " kO/s )";
         }
 
         //Normal
         {
-            string filenameExt = folderTmp + queriesNormal[1] + ".so";
-            void* handle = dlopen(filenameExt.c_str(), RTLD_NOW);
+            Varchar<20>& city = updateNormal.parameter<Varchar<20>>(0);
+            Integer& id = updateNormal.parameter<Integer>(1);
             high_resolution_clock::time_point start = high_resolution_clock::now();
-            auto query = reinterpret_cast<queryType>(dlsym(handle, "query"));
 
             for (int i = 6; i < iterationsUpdate; i++) {
-                genRandom(params[0], 10);
-                params[1] = to_string(i);
-                query(db, params, false);
+                genRandom(city, 10);
+                id.value = i;
+                updateNormal.execute(db);
             }
 
-            dlclose(handle);
             time = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
             cout << " / Normal: " << time << "ms (" << (iterationsUpdate / (time / 1000.0)) / 1000.0 << " kO/s )";
         }
@@ -324,34 +623,28 @@ void DatabaseTools::performanceTest(Schema* s, Database* db) {
     try {
         //Temporal
         {
-            string filenameExt = folderTmp + queriesTemporal[2] + ".so";
-            void* handle = dlopen(filenameExt.c_str(), RTLD_NOW);
+            Integer& id = deleteTemporal.parameter<Integer>(0);
             high_resolution_clock::time_point start = high_resolution_clock::now();
-            auto query = reinterpret_cast<queryType>(dlsym(handle, "query"));
 
             for (int i = 0; i < iterationsInsert; i++) {
-                params[0] = to_string(i);
-                query(db, params, false);
+                id.value = i;
+                deleteTemporal.execute(db);
             }
 
-            dlclose(handle);
             timeTemporal = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
             cout << "Delete - Temporal: " << timeTemporal << "ms (" << (iterationsInsert / (timeTemporal / 1000.0)) / 1000.0 << " kO/s )";
         }
 
         //Normal
         {
-            string filenameExt = folderTmp + queriesNormal[2] + ".so";
-            void* handle = dlopen(filenameExt.c_str(), RTLD_NOW);
+            Integer& id = deleteNormal.parameter<Integer>(0);
             high_resolution_clock::time_point start = high_resolution_clock::now();
-            auto query = reinterpret_cast<queryType>(dlsym(handle, "query"));
 
             for (int i = 0; i < iterationsInsert; i++) {
-                params[0] = to_string(i);
-                query(db, params, false);
+                id.value = i;
+                deleteNormal.execute(db);
             }
 
-            dlclose(handle);
             time = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
             cout << " / Normal: " << time << "ms (" << (iterationsInsert / (time / 1000.0)) / 1000.0 << " kO/s )";
         }
@@ -381,38 +674,22 @@ void DatabaseTools::performanceTest2(Schema* s, Database* db) {
     string queriesTemporal[3], queriesNormal[3];
 
     {
-#pragma omp parallel sections
-        {
-#pragma omp section
-            {
-                queriesTemporal[0] = DatabaseTools::parseAndWriteQuery("INSERT INTO warehouse (w_id, w_city) VALUES (?,?)", s);
-                DatabaseTools::compileFile(queriesTemporal[0]);
-            }
-#pragma omp section
-            {
-                queriesTemporal[1] = DatabaseTools::parseAndWriteQuery("UPDATE warehouse SET w_city=? WHERE w_id=?", s);
-                DatabaseTools::compileFile(queriesTemporal[1]);
-            }
-#pragma omp section
-            {
-                queriesTemporal[2] = DatabaseTools::parseAndWriteQuery("SELECT * FROM warehouse", s);
-                DatabaseTools::compileFile(queriesTemporal[2]);
-            }
-#pragma omp section
-            {
-                queriesNormal[0] = DatabaseTools::parseAndWriteQuery("INSERT INTO warehouseold (w_id, w_city) VALUES (?,?)", s);
-                DatabaseTools::compileFile(queriesNormal[0]);
-            }
-#pragma omp section
-            {
-                queriesNormal[1] = DatabaseTools::parseAndWriteQuery("UPDATE warehouseold SET w_city=? WHERE w_id=?", s);
-                DatabaseTools::compileFile(queriesNormal[1]);
-            }
-#pragma omp section
-            {
-                queriesNormal[2] = DatabaseTools::parseAndWriteQuery("SELECT * FROM warehouseold", s);
-                DatabaseTools::compileFile(queriesNormal[2]);
-            }
+        //The builds run in parallel on the workers of the compiler
+        vector<shared_future<long>> builds;
+        queriesTemporal[0] = DatabaseTools::parseAndWriteQuery("INSERT INTO warehouse (w_id, w_city) VALUES (?,?)", s);
+        builds.push_back(submitFile(queriesTemporal[0]));
+        queriesTemporal[1] = DatabaseTools::parseAndWriteQuery("UPDATE warehouse SET w_city=? WHERE w_id=?", s);
+        builds.push_back(submitFile(queriesTemporal[1]));
+        queriesTemporal[2] = DatabaseTools::parseAndWriteQuery("SELECT * FROM warehouse", s);
+        builds.push_back(submitFile(queriesTemporal[2]));
+        queriesNormal[0] = DatabaseTools::parseAndWriteQuery("INSERT INTO warehouseold (w_id, w_city) VALUES (?,?)", s);
+        builds.push_back(submitFile(queriesNormal[0]));
+        queriesNormal[1] = DatabaseTools::parseAndWriteQuery("UPDATE warehouseold SET w_city=? WHERE w_id=?", s);
+        builds.push_back(submitFile(queriesNormal[1]));
+        queriesNormal[2] = DatabaseTools::parseAndWriteQuery("SELECT * FROM warehouseold", s);
+        builds.push_back(submitFile(queriesNormal[2]));
+        for (auto& build : builds) {
+            build.wait();
         }
     }
     cout << ": done." << endl;
@@ -423,18 +700,6 @@ void DatabaseTools::performanceTest2(Schema* s, Database* db) {
 
     {
 
-        string filenameExt1 = folderTmp + queriesTemporal[0] + ".so";
-        void* handleInsert = dlopen(filenameExt1.c_str(), RTLD_NOW);
-        string filenameExt2 = folderTmp + queriesTemporal[1] + ".so";
-        void* handleUpdate = dlopen(filenameExt2.c_str(), RTLD_NOW);
-        string filenameExt3 = folderTmp + queriesTemporal[2] + ".so";
-        void* handleSelect = dlopen(filenameExt3.c_str(), RTLD_NOW);
-
-        auto queryInsert = reinterpret_cast<queryType>(dlsym(handleInsert, "query"));
-        auto queryUpdate = reinterpret_cast<queryType>(dlsym(handleUpdate, "query"));
-        auto querySelect = reinterpret_cast<queryType>(dlsym(handleSelect, "query"));
-
-
         int pkAutoIncrement = 5;
         for (int i = 0; i < iterationsRounds; i++) {
             int target = pkAutoIncrement + iterationsInsert;
@@ -443,7 +708,7 @@ void DatabaseTools::performanceTest2(Schema* s, Database* db) {
             for (; pkAutoIncrement < target; pkAutoIncrement++) {
                 params[0] = to_string(pkAutoIncrement);
                 genRandom(params[1], 10);
-                queryInsert(db, params, false);
+                runQuery(queriesTemporal[0], db, params);
             }
 
             //Do some updates
@@ -451,38 +716,22 @@ void DatabaseTools::performanceTest2(Schema* s, Database* db) {
             for (; pkAutoIncrement < target; pkAutoIncrement++) {
                 params[1] = to_string(pkAutoIncrement);
                 genRandom(params[0], 10);
-                queryUpdate(db, params, false);
+                runQuery(queriesTemporal[1], db, params);
             }
 
             //Test table scan
             high_resolution_clock::time_point start = high_resolution_clock::now();
             for (int j = 0; j < iterationsSelect; j++) {
-                querySelect(db, params, false);
+                runQuery(queriesTemporal[2], db, params);
             }
             time = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
             cout << "With " << getSize(db, "wh") << " records took: " << time << "ms" << endl;
         }
-
-        dlclose(handleInsert);
-        dlclose(handleUpdate);
-        dlclose(handleSelect);
     }
     cout << endl;
     cout << "old fashion: " << endl;
     try {
 
-        string filenameExt1 = folderTmp + queriesNormal[0] + ".so";
-        void* handleInsert = dlopen(filenameExt1.c_str(), RTLD_NOW);
-        string filenameExt2 = folderTmp + queriesNormal[1] + ".so";
-        void* handleUpdate = dlopen(filenameExt2.c_str(), RTLD_NOW);
-        string filenameExt3 = folderTmp + queriesNormal[2] + ".so";
-        void* handleSelect = dlopen(filenameExt3.c_str(), RTLD_NOW);
-
-        auto queryInsert = reinterpret_cast<queryType>(dlsym(handleInsert, "query"));
-        auto queryUpdate = reinterpret_cast<queryType>(dlsym(handleUpdate, "query"));
-        auto querySelect = reinterpret_cast<queryType>(dlsym(handleSelect, "query"));
-
-
         int pkAutoIncrement = 5;
         for (int i = 0; i < iterationsRounds; i++) {
             int target = pkAutoIncrement + iterationsInsert;
@@ -492,7 +741,7 @@ void DatabaseTools::performanceTest2(Schema* s, Database* db) {
                 params[0] = to_string(pkAutoIncrement);
                 genRandom(params[1], 10);
                 try {
-                    queryInsert(db, params, false);
+                    runQuery(queriesNormal[0], db, params);
                 } catch (const char* e) {}
             }
 
@@ -501,21 +750,17 @@ void DatabaseTools::performanceTest2(Schema* s, Database* db) {
             for (; pkAutoIncrement < target; pkAutoIncrement++) {
                 params[1] = to_string(pkAutoIncrement);
                 genRandom(params[0], 10);
-                queryUpdate(db, params, false);
+                runQuery(queriesNormal[1], db, params);
             }
 
             //Test table scan
             high_resolution_clock::time_point start = high_resolution_clock::now();
             for (int j = 0; j < iterationsSelect; j++) {
-                querySelect(db, params, false);
+                runQuery(queriesNormal[2], db, params);
             }
             time = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
             cout << "With " << getSize(db, "who") << " records took: " << time << "ms" << endl;
         }
-
-        dlclose(handleInsert);
-        dlclose(handleUpdate);
-        dlclose(handleSelect);
     } catch (const char* e) {
         cerr << e << endl;
     }
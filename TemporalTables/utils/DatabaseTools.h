@@ -15,37 +15,113 @@
 #include <string>
 #include <stdlib.h>
 #include <dlfcn.h>
+#include <set>
 #include <iostream>
 #include <fstream>
 #include "../parser/SchemaParser.hpp"
 #include "../parser/SQLLexer.hpp"
 #include "../parser/SQLParser.hpp"
 #include "md5.h"
+#include "PlanRegistry.h"
+#include "CompileService.h"
 #include <boost/algorithm/string/replace.hpp>
 
 using namespace std;
 struct Database;
 
 struct DatabaseTools {
+    using Tier = PlanRegistry::Tier;
+
+    /// How queries are run: interpreted the first time and compiled when they are repeated, or always one way
+    enum class Engine {
+        Auto, Compile, Interpret
+    };
 
     static const string dbName;
     static const string dbNameCompiled;
+    /// Header included by all queries: the database header and the utilities of the generated code
+    static const string queryHeader;
     static const string folderTmp;
     static const string folderTable;
     static const char* cmdBuild;
+    static const char* cmdBuildFast;
+    static const char* cmdBuildProfiling;
+    static const char* cmdBuildProfiled;
+    static const char* cmdHeader;
+    static const char* cmdHeaderFast;
+
+    /// The compiled queries that stay loaded between executions
+    static PlanRegistry plans;
+
+    /// Runs the compiler for the queries, the schema and the headers
+    static CompileService compiler;
+
+    static Engine engine;
+    /// Queries the interpreter ran for Auto, they are compiled the next time
+    static set<string> interpreted;
+
+    /// Executions of the optimized build after which a query is profiled, and of the profiling build after which it is
+    /// compiled with the profile. 0 to never profile
+    static uint64_t profileRuns;
+    /// Queries that were profiled, they are only profiled once
+    static set<string> profiled;
 
     static void split(const std::string& str, std::vector<std::string>& lineChunks);
 
-    static long compileFile(const string name);
+    static long compileFile(const string name, Tier tier = Tier::Optimized);
+
+    /// Queue the build of a file with the compiler service
+    static shared_future<long> submitFile(const string& name, Tier tier = Tier::Optimized, bool urgent = false);
+
+    /// Compile a query in tiers. Unless its optimized build is on disk, the fast build is compiled and registered in the
+    /// plans in its place, while the optimized build is compiled in the background. The future is ready with the
+    /// milliseconds of the fast build, 0 if there was nothing to wait for and -1 if it failed
+    static shared_future<long> compileTiered(const string name);
+
+    /// Wait until the optimized builds in the background are done
+    static void waitForBuilds();
+
+    /// The compiled library of a query or the database
+    static string library(const string& name, Tier tier = Tier::Optimized);
+
+    /// Precompile a header in the tmp folder for a tier, the queries including it first skip parsing it
+    static long compileHeader(const string name, Tier tier);
 
     static Database* loadAndRunDb(string filename);
 
-    static long loadAndRunQuery(string filename, Database* db, vector<string>&);
+    /// Extend the statistics of all relations in the schema by the rows added since they were last analyzed
+    static void loadStatistics(Schema* s, Database* db);
+
+    /// Compute the statistics of a relation, or of all relations if it is empty, from scratch and print them
+    static void analyze(Schema* s, Database* db, const string& relation);
+
+    /// The library of the database, it stays loaded
+    static void* databaseLibrary();
+
+    /// Run a query with the interpreter, if the engine chooses it for the query and the interpreter supports its plan.
+    /// Returns the microseconds of the execution, -1 if the query has to be compiled
+    static long interpretQuery(const string& query, Schema* s, Database* db, Engine engine);
+
+    /// Run a compiled query, tier is set to the build that ran. Returns the microseconds of the execution
+    static long loadAndRunQuery(string filename, Database* db, vector<string>&, Tier* tier = nullptr);
+
+    /// Run a compiled query without timing it or catching its errors, for statements that run many times
+    static void runQuery(const string& filename, Database* db, vector<string>& params);
+
+    /// Count an execution of a build of a query. A hot query is compiled with a profile in the background: after
+    /// profileRuns executions of its optimized build, a build collecting the profile runs in its place, and after as
+    /// many executions of that one, the build compiled with the profile.
+    static void recompileHot(const string& filename, Tier tier, uint64_t runs);
 
     static Schema* parseAndWriteSchema(const string& schemaFile);
 
     static string parseAndWriteQuery(const string& query, Schema* s);
 
+    /// Parse a query and write its code, returns the name of the compiled file. The constants of a query without
+    /// question marks are replaced by parameters and their values added to params, queries that only differ in
+    /// their constants share the compiled file.
+    static string parseAndWriteQuery(const string& query, Schema* s, vector<string>& params);
+
     static void performanceTest(Schema* s, Database*);
 
     static void performanceTest2(Schema* s, Database*);
@@ -67,6 +143,58 @@ struct DatabaseTools {
         myfile.close();
     }
 
+    /// Key of a string value for the statistics
+    template<typename T>
+    static auto statisticsKey(const T& value, int) -> decltype(value.begin(), value.length(), double()) {
+        return ColumnStatistics::stringKey(value.begin(), value.length());
+    }
+
+    /// Key of a number, date or timestamp for the statistics, its raw value
+    template<typename T>
+    static auto statisticsKey(const T& value, long) -> decltype((double) value.value) {
+        return (double) value.value;
+    }
+
+    /// A value as it is printed, for the minimum and maximum of the statistics
+    template<typename T>
+    static std::string statisticsText(const T& value) {
+        std::stringstream out;
+        out << value;
+        return out.str();
+    }
+
+    /// Add the values of a column in the rows from the given one on to its statistics. The column is at the
+    /// given offset in rows of the given size, so there is only one instantiation per type.
+    template<typename T>
+    static void analyzeColumn(const void* table, size_t rowSize, size_t offset, size_t from, size_t to, ColumnStatistics& column) {
+        const double min = column.min, max = column.max;
+        const T* minValue = nullptr;
+        const T* maxValue = nullptr;
+        std::vector<double> keys;
+        std::vector<uint64_t> hashes;
+        keys.reserve(to - from);
+        hashes.reserve(to - from);
+        for (size_t i = from; i < to; i++) {
+            const T& value = *reinterpret_cast<const T*>(static_cast<const char*>(table) + i * rowSize + offset);
+            keys.push_back(statisticsKey(value, 0));
+            hashes.push_back(value.hash());
+            if (!minValue || value < *minValue) {
+                minValue = &value;
+            }
+            if (!maxValue || *maxValue < value) {
+                maxValue = &value;
+            }
+        }
+        column.add(keys, hashes);
+
+        if (minValue && column.min < min) {
+            column.minText = statisticsText(*minValue);
+        }
+        if (maxValue && column.max > max) {
+            column.maxText = statisticsText(*maxValue);
+        }
+    }
+
 };
 
 #endif //TASK5_DATABASETOOLS_H
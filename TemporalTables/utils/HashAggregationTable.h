@@ -0,0 +1,67 @@
+#ifndef HASH_AGGREGATION_TABLE_H
+#define HASH_AGGREGATION_TABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "HashJoinTable.h"
+
+// Hash table for the groups of the generated hash aggregations
+//
+// Like the HashJoinTable all groups are kept in one contiguous vector with their hash, the directory only holds
+// indexes into it. The table does not know how to aggregate, the generated code passes one function creating the
+// state of a new group from the current tuple and one function updating the state of an existing group.
+template<typename Key, typename Value>
+class HashAggregationTable {
+public:
+    struct Entry {
+        uint64_t hash;
+        /// Index of the next entry in the bucket plus one, 0 ends the chain
+        uint32_t next;
+        Key key;
+        Value value;
+    };
+
+private:
+    std::vector<Entry> entries;
+    std::vector<uint32_t> directory = std::vector<uint32_t>(1024, 0);
+    uint64_t mask = 1023;
+
+    void grow() {
+        directory.assign(directory.size() * 2, 0);
+        mask = directory.size() - 1;
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            uint32_t& head = directory[(entries[i].hash >> 32) & mask];
+            entries[i].next = head;
+            head = i + 1;
+        }
+    }
+
+public:
+    /// Update the group of the key, or create it with the value returned by init
+    template<typename Init, typename Update>
+    void aggregate(const Key& key, Init&& init, Update&& update) {
+        const uint64_t hash = HashJoinTable<Key, Value>::hash(key);
+        uint32_t& head = directory[(hash >> 32) & mask];
+        for (uint32_t i = head; i != 0; i = entries[i - 1].next) {
+            Entry& entry = entries[i - 1];
+            if (entry.hash == hash && entry.key == key) {
+                update(entry.value);
+                return;
+            }
+        }
+
+        entries.push_back(Entry{hash, head, key, init()});
+        head = entries.size();
+        if (entries.size() * 2 > directory.size()) {
+            grow();
+        }
+    }
+
+    typename std::vector<Entry>::const_iterator begin() const { return entries.begin(); }
+
+    typename std::vector<Entry>::const_iterator end() const { return entries.end(); }
+
+    size_t size() const { return entries.size(); }
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef HASH_JOIN_TABLE_H
+#define HASH_JOIN_TABLE_H
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Hash table for the build side of the generated hash joins
+//
+// All build tuples are appended to one contiguous vector together with their hash, nothing is allocated per tuple.
+// Once the build side is done, finalize() sizes the directory from the exact number of entries and links every entry
+// into its bucket chain. Probing compares the stored hash before the key and walks the chain by index.
+//
+// finalize() also builds a blocked Bloom filter over the keys, with 16 bits per key and three bits per key in one
+// 64 bit word. mayContain() only touches that word, so the probe side can drop most tuples without a match before
+// they reach the directory, see HashJoin.
+template<typename Key, typename Value>
+class HashJoinTable {
+    struct Entry {
+        uint64_t hash;
+        /// Index of the next entry in the bucket plus one, 0 ends the chain
+        uint32_t next;
+        Key key;
+        Value value;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> directory;
+    uint64_t mask = 0;
+    std::vector<uint64_t> filter;
+    uint64_t filterMask = 0;
+
+    /// Bits of the Bloom filter for a hash, the word is chosen by the lowest bits
+    static uint64_t filterBits(uint64_t hash) {
+        return (1ull << ((hash >> 40) & 63)) | (1ull << ((hash >> 46) & 63)) | (1ull << ((hash >> 52) & 63));
+    }
+
+    template<size_t index = 0>
+    static typename std::enable_if<index == std::tuple_size<Key>::value, uint64_t>::type hashKey(const Key&, uint64_t seed) {
+        return seed;
+    }
+
+    template<size_t index = 0>
+    static typename std::enable_if<index < std::tuple_size<Key>::value, uint64_t>::type hashKey(const Key& key, uint64_t seed = 0) {
+        // Multiply after every column, so that keys with swapped columns do not collide
+        return hashKey<index + 1>(key, (seed ^ std::get<index>(key).hash()) * 0x9e3779b97f4a7c15ull);
+    }
+
+public:
+    /// Hash of a key, also used to group by the key in HashAggregationTable
+    static uint64_t hash(const Key& key) { return hashKey(key); }
+
+    void insert(const Key& key, const Value& value) {
+        entries.push_back(Entry{hashKey(key), 0, key, value});
+    }
+
+    /// Build the directory, has to be called after the last insert and before the first probe
+    void finalize() {
+        size_t capacity = 16;
+        while (capacity < 2 * entries.size()) {
+            capacity *= 2;
+        }
+        directory.assign(capacity, 0);
+        mask = capacity - 1;
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            // The upper bits are the best mixed ones
+            uint32_t& head = directory[(entries[i].hash >> 32) & mask];
+            entries[i].next = head;
+            head = i + 1;
+        }
+
+        size_t words = 1;
+        while (words * 4 < entries.size()) {
+            words *= 2;
+        }
+        filter.assign(words, 0);
+        filterMask = words - 1;
+        for (auto& entry : entries) {
+            filter[entry.hash & filterMask] |= filterBits(entry.hash);
+        }
+    }
+
+    /// Check the Bloom filter, false if the key is certainly not in the table
+    bool mayContain(const Key& key) const {
+        const uint64_t hash = hashKey(key);
+        const uint64_t bits = filterBits(hash);
+        return (filter[hash & filterMask] & bits) == bits;
+    }
+
+    /// Call f(value) for every entry with the given key
+    template<typename F>
+    void probe(const Key& key, F&& f) const {
+        const uint64_t hash = hashKey(key);
+        for (uint32_t i = directory[(hash >> 32) & mask]; i != 0; i = entries[i - 1].next) {
+            const Entry& entry = entries[i - 1];
+            if (entry.hash == hash && entry.key == key) {
+                f(entry.value);
+            }
+        }
+    }
+
+    size_t size() const { return entries.size(); }
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef INDEX_TOOLS_H
+#define INDEX_TOOLS_H
+
+#include <sys/types.h>
+
+// Maintenance of the secondary indexes of the generated relations, kept apart from DatabaseTools so that the
+// database header the queries are compiled against does not depend on the parsers
+struct IndexTools {
+    /// Remove the entry of row i from an index that allows duplicate keys
+    template<typename Index, typename Key>
+    static void eraseIndexEntry(Index& index, const Key& key, u_int32_t i) {
+        auto range = index.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == i) {
+                index.erase(it);
+                return;
+            }
+        }
+    }
+
+    /// Point the entry of a row that moved from one position in the table to another
+    template<typename Index, typename Key>
+    static void moveIndexEntry(Index& index, const Key& key, u_int32_t from, u_int32_t to) {
+        auto range = index.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == from) {
+                it->second = to;
+                return;
+            }
+        }
+    }
+};
+
+#endif //INDEX_TOOLS_H
@@ -0,0 +1,77 @@
+#ifndef PARAMETER_LAYOUT_H
+#define PARAMETER_LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Types.hpp"
+
+/// A LIKE pattern bound as a parameter, it points into a string of the caller that has to live until the query ran
+struct Pattern {
+    const char* value = "";
+    uint32_t len = 0;
+
+    const char* begin() const { return value; }
+
+    unsigned length() const { return len; }
+};
+
+// The typed parameters of a compiled query, exported by its library
+//
+// The parameters are bound into one block in the types of the columns they are compared with or assigned to, and the
+// query reads them from there instead of casting strings. The compiler of the query lays the block out, the library
+// tells where every parameter is.
+struct ParameterLayout {
+    struct Parameter {
+        /// Type in the generated code like Integer or Varchar<16>, empty if the query does not read the parameter
+        std::string type;
+        size_t offset;
+    };
+
+    size_t size = 0;
+    size_t alignment = 1;
+    /// In the order of the parameters of the query
+    std::vector<Parameter> parameters;
+};
+
+/// Name of a type of the generated code, as in the layout of the parameters
+template<typename T>
+struct ParameterType;
+
+template<>
+struct ParameterType<Integer> {
+    static std::string name() { return "Integer"; }
+};
+
+template<unsigned len, unsigned precision>
+struct ParameterType<Numeric<len, precision>> {
+    static std::string name() { return "Numeric<" + std::to_string(len) + ", " + std::to_string(precision) + ">"; }
+};
+
+template<unsigned maxLen>
+struct ParameterType<Char<maxLen>> {
+    static std::string name() { return "Char<" + std::to_string(maxLen) + ">"; }
+};
+
+template<unsigned maxLen>
+struct ParameterType<Varchar<maxLen>> {
+    static std::string name() { return "Varchar<" + std::to_string(maxLen) + ">"; }
+};
+
+template<>
+struct ParameterType<Date> {
+    static std::string name() { return "Date"; }
+};
+
+template<>
+struct ParameterType<Timestamp> {
+    static std::string name() { return "Timestamp"; }
+};
+
+template<>
+struct ParameterType<Pattern> {
+    static std::string name() { return "Pattern"; }
+};
+
+#endif //PARAMETER_LAYOUT_H
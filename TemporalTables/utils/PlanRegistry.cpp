@@ -0,0 +1,175 @@
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <dlfcn.h>
+#include "PlanRegistry.h"
+#include "ParameterLayout.h"
+
+PlanRegistry::PlanRegistry(size_t limit) : limit(max<size_t>(1, limit)) {
+}
+
+PlanRegistry::~PlanRegistry() {
+    for (auto& plan : plans) {
+        dlclose(plan.second.handle);
+    }
+}
+
+PlanRegistry::Plan* PlanRegistry::find(const string& filename) {
+    auto build = builds.find(filename);
+    const Build wanted = build != builds.end() ? build->second : Build{filename, Tier::Optimized};
+
+    auto it = plans.find(filename);
+    if (it != plans.end() && it->second.library != wanted.library) {
+        //Another build of the file is done, it replaces the loaded one
+        void* handle = it->second.handle;
+        recent.erase(it->second.position);
+        plans.erase(it);
+        if (dlclose(handle)) {
+            cerr << "error: " << dlerror() << endl;
+        }
+        swaps++;
+        it = plans.end();
+    }
+    if (it != plans.end()) {
+        hits++;
+        recent.splice(recent.begin(), recent, it->second.position);
+        return &it->second;
+    }
+    misses++;
+    return load(filename, wanted.library, wanted.tier);
+}
+
+PlanRegistry::Plan* PlanRegistry::use(const string& filename, Tier* tier, uint64_t* runs) {
+    Plan* plan = find(filename);
+    if (!plan) {
+        return nullptr;
+    }
+    plan->runs++;
+    if (tier) {
+        *tier = plan->tier;
+    }
+    if (runs) {
+        *runs = plan->runs;
+    }
+    return plan;
+}
+
+PlanRegistry::QueryFunction PlanRegistry::get(const string& filename, Tier* tier, uint64_t* runs) {
+    lock_guard<mutex> guard(lock);
+    Plan* plan = use(filename, tier, runs);
+    return plan ? plan->function : nullptr;
+}
+
+PlanRegistry::BoundFunction PlanRegistry::getBound(const string& filename, Tier* tier, uint64_t* runs) {
+    lock_guard<mutex> guard(lock);
+    Plan* plan = use(filename, tier, runs);
+    return plan ? plan->bound : nullptr;
+}
+
+bool PlanRegistry::getLayout(const string& filename, ParameterLayout& layout) {
+    lock_guard<mutex> guard(lock);
+    Plan* plan = find(filename);
+    if (!plan || !plan->layout) {
+        return false;
+    }
+    layout = *plan->layout;
+    return true;
+}
+
+PlanRegistry::Plan* PlanRegistry::load(const string& filename, const string& library, Tier tier) {
+    void* handle = dlopen(library.c_str(), RTLD_NOW);
+    if (!handle) {
+        cerr << "error loading " << library << ": " << dlerror() << endl;
+        return nullptr;
+    }
+    auto function = reinterpret_cast<QueryFunction>(dlsym(handle, "query"));
+    if (!function) {
+        cerr << "error: " << dlerror() << endl;
+        dlclose(handle);
+        return nullptr;
+    }
+    //The entry points for typed parameters, see ParameterLayout
+    auto bound = reinterpret_cast<BoundFunction>(dlsym(handle, "queryBound"));
+    auto layout = reinterpret_cast<const ParameterLayout* (*)()>(dlsym(handle, "parameterLayout"));
+    loads++;
+
+    recent.push_front(filename);
+    Plan& plan = plans[filename] = Plan{handle, function, bound, layout ? layout() : nullptr, recent.begin(), library, tier, 0};
+    while (plans.size() > limit) {
+        unloadLeastRecent();
+    }
+    return &plan;
+}
+
+void PlanRegistry::optimizing(const string& filename, const string& fastBuild) {
+    lock_guard<mutex> guard(lock);
+    builds[filename] = Build{fastBuild, Tier::Fast};
+}
+
+void PlanRegistry::optimized(const string& filename, long milliseconds) {
+    lock_guard<mutex> guard(lock);
+    auto build = builds.find(filename);
+    if (milliseconds >= 0 && build != builds.end() && build->second.tier == Tier::Fast) {
+        builds.erase(build);
+        optimizeTimes[filename] = milliseconds;
+    }
+}
+
+void PlanRegistry::replace(const string& filename, const string& library, Tier tier) {
+    lock_guard<mutex> guard(lock);
+    builds[filename] = Build{library, tier};
+}
+
+void PlanRegistry::restore(const string& filename) {
+    lock_guard<mutex> guard(lock);
+    builds.erase(filename);
+    auto it = plans.find(filename);
+    if (it != plans.end() && it->second.library != filename) {
+        recent.splice(recent.end(), recent, it->second.position);
+        unloadLeastRecent();
+        swaps++;
+    }
+}
+
+long PlanRegistry::optimizeTime(const string& filename) const {
+    lock_guard<mutex> guard(lock);
+    auto it = optimizeTimes.find(filename);
+    return it != optimizeTimes.end() ? it->second : -1;
+}
+
+void PlanRegistry::unloadLeastRecent() {
+    auto it = plans.find(recent.back());
+    if (dlclose(it->second.handle)) {
+        cerr << "error: " << dlerror() << endl;
+    }
+    plans.erase(it);
+    recent.pop_back();
+    unloads++;
+}
+
+void PlanRegistry::setLimit(size_t limit) {
+    lock_guard<mutex> guard(lock);
+    this->limit = max<size_t>(1, limit);
+    while (plans.size() > this->limit) {
+        unloadLeastRecent();
+    }
+}
+
+size_t PlanRegistry::size() const {
+    lock_guard<mutex> guard(lock);
+    return plans.size();
+}
+
+string PlanRegistry::toString() const {
+    lock_guard<mutex> guard(lock);
+    stringstream out;
+    out << "Loaded queries: " << plans.size() << " of at most " << limit << endl;
+    out << "Hits: " << hits << ", misses: " << misses << ", loads: " << loads << ", unloads: " << unloads << endl;
+    size_t count[4] = {0, 0, 0, 0};
+    for (auto& build : builds) {
+        count[(int) build.second.tier]++;
+    }
+    out << "Builds replaced: " << swaps << ", still optimizing: " << count[(int) Tier::Fast]
+        << ", profiling: " << count[(int) Tier::Profiling] << ", profile-guided: " << count[(int) Tier::Profiled];
+    return out.str();
+}
@@ -0,0 +1,129 @@
+#ifndef TASK5_PLANREGISTRY_H
+#define TASK5_PLANREGISTRY_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+using namespace std;
+struct Database;
+struct ParameterLayout;
+
+/// Keeps the libraries of compiled queries loaded, so that running a query again only calls its function instead of
+/// loading and relocating the library every time. When more than the limit are loaded, the least recently used
+/// library is unloaded.
+///
+/// A new query can be run from a fast build while its optimized build is compiled in the background. The fast build
+/// is loaded in place of the file until the optimized build is done, the next get swaps the optimized build in.
+/// In the same way a hot query runs from a build collecting a profile of its executions for a while and then from
+/// the build compiled with that profile.
+class PlanRegistry {
+public:
+    using QueryFunction = void (*)(Database*, const vector<string>&, bool);
+    /// Entry point taking a block of typed parameters, see ParameterLayout
+    using BoundFunction = void (*)(Database*, const void*, bool);
+
+    /// Build of a compiled query
+    enum class Tier {
+        Fast, Optimized, Profiling, Profiled
+    };
+
+private:
+    struct Plan {
+        void* handle;
+        QueryFunction function;
+        BoundFunction bound;
+        const ParameterLayout* layout;
+        /// Position in the list of recently used files
+        list<string>::iterator position;
+        string library;
+        Tier tier;
+        /// Times the function was returned since the library was loaded
+        uint64_t runs;
+    };
+
+    /// A library loaded in place of a file
+    struct Build {
+        string library;
+        Tier tier;
+    };
+
+    unordered_map<string, Plan> plans;
+    /// Builds that run in place of the files, the fast builds of files whose optimized build is not done yet and the
+    /// profiling and profiled builds of hot files
+    unordered_map<string, Build> builds;
+    /// Milliseconds the optimized builds in the background took
+    unordered_map<string, long> optimizeTimes;
+    /// Names of the loaded files, the most recently used first
+    list<string> recent;
+    size_t limit;
+    mutable mutex lock;
+
+    void unloadLeastRecent();
+
+    /// Load the library and register its query function for the file
+    Plan* load(const string& filename, const string& library, Tier tier);
+
+    /// The loaded plan of the file, swapped for the build that replaced it and loaded if it is not
+    Plan* find(const string& filename);
+
+    /// Count a run of the plan of the file, nullptr if it cannot be loaded
+    Plan* use(const string& filename, Tier* tier, uint64_t* runs);
+
+public:
+    /// Queries that were still loaded, that had to be loaded and libraries that were unloaded
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t loads = 0;
+    uint64_t unloads = 0;
+    /// Loaded builds that were replaced by another build of their file
+    uint64_t swaps = 0;
+
+    explicit PlanRegistry(size_t limit = 64);
+
+    ~PlanRegistry();
+
+    /// The query function of the compiled file, loaded if it is not. Until the optimized build of the file is done, the
+    /// function of its fast build. tier is set to the build that is returned and runs to the times it was returned
+    /// since it was loaded, this time included. nullptr if the library cannot be loaded
+    QueryFunction get(const string& filename, Tier* tier = nullptr, uint64_t* runs = nullptr);
+
+    /// Like get, the function of the file taking its parameters as a block of typed values
+    BoundFunction getBound(const string& filename, Tier* tier = nullptr, uint64_t* runs = nullptr);
+
+    /// Copy the layout of the typed parameters of the file into layout, false if the library cannot be loaded
+    bool getLayout(const string& filename, ParameterLayout& layout);
+
+    /// Load the fast build in place of the file until its optimized build is done
+    void optimizing(const string& filename, const string& fastBuild);
+
+    /// The optimized build of the file is done after the given milliseconds, -1 if it failed and the fast build stays.
+    /// Called from the thread that compiled it, the optimized build is only loaded by the next get so that a running
+    /// query keeps its library.
+    void optimized(const string& filename, long milliseconds);
+
+    /// Load another build of the file in place of it from the next get on
+    void replace(const string& filename, const string& library, Tier tier);
+
+    /// Load the file itself again instead of the build that replaced it. The build is unloaded right away, so that a
+    /// profiling build writes its profile, it must not be running.
+    void restore(const string& filename);
+
+    /// Milliseconds the optimized build of the file took in the background, -1 if it was not compiled in the background
+    long optimizeTime(const string& filename) const;
+
+    /// Change the number of loaded libraries, at least one
+    void setLimit(size_t limit);
+
+    size_t getLimit() const { return limit; }
+
+    size_t size() const;
+
+    string toString() const;
+};
+
+
+#endif //TASK5_PLANREGISTRY_H
@@ -0,0 +1,50 @@
+#include "PreparedStatement.h"
+#include "DatabaseTools.h"
+
+PreparedStatement::PreparedStatement(const string& query, Schema* s)
+        : filename(DatabaseTools::parseAndWriteQuery(query, s, constants)), build(DatabaseTools::submitFile(filename)) {
+}
+
+void PreparedStatement::wait() {
+    if (!block.empty()) {
+        return;
+    }
+    if (build.get() < 0) {
+        throw "Compilation failed";
+    }
+    if (!DatabaseTools::plans.getLayout(DatabaseTools::library(filename), layout)) {
+        throw "Compiled query not found";
+    }
+    if (!constants.empty()) {
+        layout.parameters.clear();
+    }
+    //A query without parameters still gets a block to point to
+    block.assign(layout.size / sizeof(max_align_t) + 1, max_align_t());
+}
+
+size_t PreparedStatement::size() {
+    wait();
+    return layout.parameters.size();
+}
+
+const string& PreparedStatement::type(size_t index) {
+    wait();
+    return layout.parameters.at(index).type;
+}
+
+void PreparedStatement::execute(Database* db) {
+    wait();
+    if (!constants.empty()) {
+        DatabaseTools::runQuery(filename, db, constants);
+        return;
+    }
+
+    PlanRegistry::Tier tier;
+    uint64_t runs;
+    auto query = DatabaseTools::plans.getBound(DatabaseTools::library(filename), &tier, &runs);
+    if (!query) {
+        throw "Compiled query not found";
+    }
+    query(db, block.data(), false);
+    DatabaseTools::recompileHot(filename, tier, runs);
+}
@@ -0,0 +1,64 @@
+#ifndef TASK5_PREPAREDSTATEMENT_H
+#define TASK5_PREPAREDSTATEMENT_H
+
+#include <string>
+#include <vector>
+#include <future>
+#include <cstddef>
+#include "ParameterLayout.h"
+
+using namespace std;
+struct Database;
+struct Schema;
+
+/// A compiled query whose parameters are bound as typed values
+///
+/// The values are written into a block laid out like the parameters of the compiled query, in the types of the columns
+/// they are compared with or assigned to. The query reads them from there, there are no strings to pass and cast.
+/// The statement runs through the plans of DatabaseTools, so it is recompiled when it is hot like any other query.
+class PreparedStatement {
+    /// Constants of a query without question marks, they are parameters of the compiled query shared with the same
+    /// query with other constants
+    vector<string> constants;
+    string filename;
+    shared_future<long> build;
+    ParameterLayout layout;
+    /// The parameters, aligned for all of them
+    vector<max_align_t> block;
+
+public:
+    /// Parse the query with question marks for its parameters and queue its build, it is compiled in the background
+    /// until the statement is first used
+    PreparedStatement(const string& query, Schema* s);
+
+    /// Wait until the query is compiled and allocate the block for its parameters, the first use does it
+    void wait();
+
+    /// Number of parameters of the query
+    size_t size();
+
+    /// Type of a parameter like Integer or Varchar<16>, Pattern for a LIKE pattern
+    const string& type(size_t index);
+
+    /// The value of a parameter in the block, it stays bound for all executions until it is changed. Throws if the
+    /// parameter has another type
+    template<typename T>
+    T& parameter(size_t index) {
+        wait();
+        if (index >= layout.parameters.size() || layout.parameters[index].type != ParameterType<T>::name()) {
+            throw "Parameter does not exist or has another type";
+        }
+        return *reinterpret_cast<T*>(reinterpret_cast<char*>(block.data()) + layout.parameters[index].offset);
+    }
+
+    template<typename T>
+    void bind(size_t index, const T& value) {
+        parameter<T>(index) = value;
+    }
+
+    /// Run the query with the bound parameters, without output
+    void execute(Database* db);
+};
+
+
+#endif //TASK5_PREPAREDSTATEMENT_H
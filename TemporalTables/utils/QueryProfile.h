@@ -0,0 +1,53 @@
+#ifndef QUERY_PROFILE_H
+#define QUERY_PROFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iomanip>
+#include <x86intrin.h>
+
+// Counters of a query compiled for EXPLAIN ANALYZE
+//
+// Every operator of the plan has a slot. The generated code counts the tuples an operator passes on to its consumer
+// and the lookups of the joins in their hash table or index. The work started by an operator, the pipeline of a scan
+// or the finalization of a hash table, is measured in cycles of the time stamp counter.
+struct QueryProfile {
+    std::vector<uint64_t> tuples;
+    std::vector<uint64_t> probes;
+    std::vector<uint64_t> cycles;
+
+    explicit QueryProfile(size_t operators) : tuples(operators, 0), probes(operators, 0), cycles(operators, 0) { }
+
+    static uint64_t now() { return __rdtsc(); }
+
+    /// Print the plan, one line per operator with its description and its depth in the tree, in the order of the slots
+    void print(const std::vector<std::pair<std::string, unsigned>>& plan) const {
+        uint64_t total = 0;
+        for (auto c : cycles) {
+            total += c;
+        }
+
+        std::cout << std::setfill(' ') << std::left << std::setw(60) << "Operator" << std::right
+                  << std::setw(12) << "Tuples" << std::setw(12) << "Probes" << std::setw(16) << "Cycles" << std::setw(8) << "%" << std::endl;
+        for (size_t i = 0; i < plan.size(); i++) {
+            const std::string name = std::string(2 * plan[i].second, ' ') + plan[i].first;
+            std::cout << std::left << std::setw(60) << name << std::right << std::setw(12) << tuples[i] << std::setw(12);
+            if (probes[i] > 0) {
+                std::cout << probes[i];
+            } else {
+                std::cout << "";
+            }
+            if (cycles[i] > 0) {
+                std::cout << std::setw(16) << cycles[i] << std::setw(7) << std::fixed << std::setprecision(1)
+                          << 100.0 * cycles[i] / total << "%";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "Total cycles: " << total << std::endl;
+    }
+};
+
+#endif //QUERY_PROFILE_H
@@ -0,0 +1,161 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+// Statistics of the columns of a table, for the estimates of the planner
+//
+// Every value of a column is mapped to a double key that keeps the order of the values: numbers and dates are their
+// raw value, strings their first eight characters. The statistics can be extended with more rows at any time: the
+// minimum and maximum, a HyperLogLog sketch of the distinct values and a reservoir sample of the keys, from which
+// the equi-depth histogram is built.
+struct ColumnStatistics {
+    /// Registers of the HyperLogLog sketch, the standard error is 1.04 / sqrt(registers)
+    static const unsigned registerBits = 10;
+    /// Keys kept in the sample
+    static const size_t sampleSize = 1024;
+    /// Buckets of the equi-depth histogram
+    static const size_t buckets = 32;
+
+    /// Rows added, including those not in the sample
+    uint64_t count = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    /// The minimum and maximum as they are printed
+    std::string minText;
+    std::string maxText;
+    std::vector<uint8_t> registers = std::vector<uint8_t>(1u << registerBits, 0);
+    std::vector<double> sample;
+    /// Bounds of the histogram, every bucket between two bounds holds the same number of rows
+    std::vector<double> bounds;
+    /// State of the random numbers choosing the sample
+    uint64_t random = 88172645463325252ull;
+
+    /// Key of a string, its first eight characters as a big endian number
+    static double stringKey(const char* begin, size_t length) {
+        uint64_t key = 0;
+        for (size_t i = 0; i < 8; i++) {
+            key = (key << 8) | (i < length ? (uint8_t) begin[i] : 0);
+        }
+        return (double) key;
+    }
+
+    /// Add the values of a batch of rows, by their keys and hashes
+    __attribute__((noinline)) void add(const std::vector<double>& keys, const std::vector<uint64_t>& hashes) {
+        for (size_t i = 0; i < keys.size(); i++) {
+            add(keys[i], hashes[i]);
+        }
+    }
+
+    void add(double key, uint64_t hash) {
+        count++;
+        min = std::min(min, key);
+        max = std::max(max, key);
+
+        //The register is chosen by the first bits, the rest counts the leading zeros
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        const uint64_t rest = (hash << registerBits) | (1ull << (registerBits - 1));
+        uint8_t& r = registers[hash >> (64 - registerBits)];
+        r = std::max<uint8_t>(r, (uint8_t) (__builtin_clzll(rest) + 1));
+
+        //Reservoir sampling, every row is in the sample with the same probability
+        if (sample.size() < sampleSize) {
+            sample.push_back(key);
+        } else {
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            const uint64_t slot = random % count;
+            if (slot < sampleSize) {
+                sample[slot] = key;
+            }
+        }
+    }
+
+    /// Build the histogram from the sample
+    void finish() {
+        std::vector<double> sorted(sample);
+        std::sort(sorted.begin(), sorted.end());
+        bounds.clear();
+        if (sorted.empty()) {
+            return;
+        }
+        const size_t n = std::min(buckets, sorted.size());
+        for (size_t i = 0; i < n; i++) {
+            bounds.push_back(sorted[i * sorted.size() / n]);
+        }
+        bounds.push_back(sorted.back());
+    }
+
+    /// Estimated number of distinct values
+    double distinct() const {
+        const double m = registers.size();
+        double sum = 0;
+        size_t zeros = 0;
+        for (auto r : registers) {
+            sum += std::ldexp(1.0, -r);
+            zeros += r == 0;
+        }
+        double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        if (estimate <= 2.5 * m && zeros > 0) {
+            //Linear counting is more precise for small cardinalities
+            estimate = m * std::log(m / zeros);
+        }
+        return std::max(1.0, std::min(estimate, (double) count));
+    }
+
+    /// Estimated fraction of the rows with a key between lower and upper
+    double range(double lower, double upper) const {
+        if (bounds.empty() || upper < lower) {
+            return 0;
+        }
+        return below(upper, true) - below(lower, false);
+    }
+
+private:
+    /// Fraction of the rows below the key, or up to it
+    double below(double key, bool inclusive) const {
+        if (key < bounds.front() || (!inclusive && key == bounds.front())) {
+            return 0;
+        }
+        if (key > bounds.back() || (inclusive && key == bounds.back())) {
+            return 1;
+        }
+        const size_t n = bounds.size() - 1;
+        const size_t bucket = std::upper_bound(bounds.begin(), bounds.end(), key) - bounds.begin() - 1;
+        const double width = bounds[bucket + 1] - bounds[bucket];
+        const double within = width > 0 ? (key - bounds[bucket]) / width : 0.5;
+        return (bucket + within) / n;
+    }
+};
+
+struct TableStatistics {
+    /// Rows of the table when the statistics were last extended
+    uint64_t rows = 0;
+    /// Rows that are included in the column statistics
+    uint64_t analyzed = 0;
+    std::vector<ColumnStatistics> columns;
+
+    bool valid() const { return !columns.empty(); }
+
+    /// Start extending the statistics to a table with the given rows, returns the first row to add.
+    /// If the table got smaller, rows were deleted and the statistics start over.
+    size_t extend(size_t size, size_t columnCount) {
+        if (size < analyzed || columns.size() != columnCount) {
+            analyzed = 0;
+            columns.assign(columnCount, ColumnStatistics());
+        }
+        const size_t from = analyzed;
+        rows = analyzed = size;
+        return from;
+    }
+};
+
+#endif //STATISTICS_H
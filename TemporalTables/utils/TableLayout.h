@@ -0,0 +1,17 @@
+#ifndef TABLE_LAYOUT_H
+#define TABLE_LAYOUT_H
+
+#include <cstddef>
+#include <vector>
+
+// Where the rows of a relation of the generated database are, for the code that is not compiled against it
+struct TableLayout {
+    /// The first row, the rows follow each other
+    const char* rows = nullptr;
+    size_t count = 0;
+    size_t rowSize = 0;
+    /// Offset of every column in a row, in the order of the attributes of the relation
+    std::vector<size_t> offsets;
+};
+
+#endif //TABLE_LAYOUT_H
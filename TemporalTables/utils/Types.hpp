@@ -1,10 +1,15 @@
 #ifndef H_Types
 #define H_Types
 //---------------------------------------------------------------------------
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <ostream>
 #include <cassert>
+#include <climits>
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
 #include <sstream>
 #include <chrono>
 
@@ -140,9 +145,21 @@ public:
     /// Comparison
     bool operator==(const Varchar& other) const { return (len == other.len) && (memcmp(value, other.value, len) == 0); }
 
+    /// Comparison
+    bool operator!=(const Varchar& other) const { return !(*this == other); }
+
     /// Comparison
     bool operator<(const Varchar& other) const;
 
+    /// Comparison
+    bool operator<=(const Varchar& other) const { return !(other < *this); }
+
+    /// Comparison
+    bool operator>(const Varchar& other) const { return other < *this; }
+
+    /// Comparison
+    bool operator>=(const Varchar& other) const { return !(*this < other); }
+
     /// Build
     static Varchar build(const char* value) {
         Varchar result;
@@ -178,7 +195,7 @@ template<unsigned maxLen>
 bool Varchar<maxLen>::operator<(const Varchar& other) const
 // Comparison
 {
-    int c = memcmp(value, other.value, min(len, other.len));
+    int c = memcmp(value, other.value, std::min(len, other.len));
     if (c < 0) { return true; }
     if (c > 0) { return false; }
     return len < other.len;
@@ -234,12 +251,21 @@ public:
     /// Comparison
     bool operator==(const Char& other) const { return (len == other.len) && (memcmp(value, other.value, len) == 0); }
 
+    /// Comparison
+    bool operator!=(const Char& other) const { return !(*this == other); }
+
     /// Comparison
     bool operator<(const Char& other) const;
 
+    /// Comparison
+    bool operator<=(const Char& other) const { return !(*this > other); }
+
     /// Comparison
     bool operator>(const Char& other) const;
 
+    /// Comparison
+    bool operator>=(const Char& other) const { return !(*this < other); }
+
     /// Build
     static Char build(const char* value) {
         Char result;
@@ -279,7 +305,7 @@ template<unsigned maxLen>
 bool Char<maxLen>::operator<(const Char& other) const
 // Comparison
 {
-    int c = memcmp(value, other.value, min(len, other.len));
+    int c = memcmp(value, other.value, std::min(len, other.len));
     if (c < 0) { return true; }
     if (c > 0) { return false; }
     return len < other.len;
@@ -290,7 +316,7 @@ template<unsigned maxLen>
 bool Char<maxLen>::operator>(const Char& other) const
 // Comparison
 {
-    int c = memcmp(value, other.value, min(len, other.len));
+    int c = memcmp(value, other.value, std::min(len, other.len));
     if (c < 0) { return false; }
     if (c > 0) { return true; }
     return len > other.len;
@@ -329,9 +355,21 @@ public:
     /// Comparison
     bool operator==(const Char& other) const { return value == other.value; }
 
+    /// Comparison
+    bool operator!=(const Char& other) const { return value != other.value; }
+
     /// Comparison
     bool operator<(const Char& other) const { return value < other.value; }
 
+    /// Comparison
+    bool operator<=(const Char& other) const { return value <= other.value; }
+
+    /// Comparison
+    bool operator>(const Char& other) const { return value > other.value; }
+
+    /// Comparison
+    bool operator>=(const Char& other) const { return value >= other.value; }
+
     /// Build
     static Char build(const char* value) {
         Char result;
@@ -367,6 +405,199 @@ std::ostream& operator<<(std::ostream& out, const Char<maxLen>& value)
     return out;
 }
 
+//---------------------------------------------------------------------------
+// Filter kernels for string columns
+//
+// A kernel scans n rows, `first` is the column in the first row and `stride` the size of a row. The indexes of the
+// qualifying rows are written to `sel`, the number of qualifying rows is returned. The kernels work for Char and
+// Varchar columns of at least two characters. With AVX2 the first four characters of eight rows are gathered and
+// compared at once, only the candidates are checked in full. With SSE4.2 substrings are searched 16 bytes at a time.
+//---------------------------------------------------------------------------
+/// SQL LIKE, '%' matches any sequence of characters and '_' a single character
+inline bool likeMatch(const char* value, unsigned len, const char* pattern, unsigned patternLen)
+// Greedy matching, on a mismatch retry after the last '%'
+{
+    unsigned v = 0, p = 0, starPattern = ~0u, starValue = 0;
+    while (v < len) {
+        if (p < patternLen && pattern[p] == '%') {
+            starPattern = p++;
+            starValue = v;
+        } else if (p < patternLen && (pattern[p] == '_' || pattern[p] == value[v])) {
+            v++;
+            p++;
+        } else if (starPattern != ~0u) {
+            p = starPattern + 1;
+            v = ++starValue;
+        } else {
+            return false;
+        }
+    }
+    while (p < patternLen && pattern[p] == '%') {
+        p++;
+    }
+    return p == patternLen;
+}
+
+//---------------------------------------------------------------------------
+/// Substring search, capacity is the size of the buffer behind value
+inline bool containsString(const char* value, unsigned len, unsigned capacity, const char* needle, unsigned needleLen)
+{
+    if (needleLen > len) { return false; }
+    if (needleLen == 0) { return true; }
+#ifdef __SSE4_2__
+    if (needleLen <= 16) {
+        char needleBuffer[16] = {};
+        memcpy(needleBuffer, needle, needleLen);
+        const __m128i pattern = _mm_loadu_si128(reinterpret_cast<const __m128i*>(needleBuffer));
+        unsigned offset = 0;
+        while (offset + needleLen <= len) {
+            const unsigned chunkLen = (len - offset < 16) ? len - offset : 16;
+            __m128i chunk;
+            if (offset + 16 <= capacity) {
+                chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + offset));
+            } else {
+                char chunkBuffer[16] = {};
+                memcpy(chunkBuffer, value + offset, chunkLen);
+                chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chunkBuffer));
+            }
+            // Index of the first (possibly partial, at the end of the chunk) occurrence of the needle
+            const unsigned index = _mm_cmpestri(pattern, needleLen, chunk, chunkLen, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ORDERED);
+            if (index == 16) {
+                offset += 16;
+            } else if (index + needleLen <= chunkLen) {
+                return true;
+            } else if (index == 0) {
+                return false;
+            } else {
+                offset += index;
+            }
+        }
+        return false;
+    }
+#endif
+    for (unsigned offset = 0; offset + needleLen <= len; offset++) {
+        if (memcmp(value + offset, needle, needleLen) == 0) { return true; }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------
+/// Rows whose string starts with the prefix, or equals it if exact is set
+template<bool exact, class String>
+unsigned selectPrefixImpl(const String* first, size_t stride, unsigned n, const char* prefix, unsigned prefixLen, uint32_t* sel)
+{
+    const char* base = reinterpret_cast<const char*>(first);
+    unsigned count = 0;
+    unsigned i = 0;
+#ifdef __AVX2__
+    if (sizeof(first->value) >= 4 && prefixLen > 0 && stride * 8 <= INT32_MAX) {
+        const unsigned wordLen = prefixLen < 4 ? prefixLen : 4;
+        uint32_t word = 0;
+        memcpy(&word, prefix, wordLen);
+        const __m256i mask = _mm256_set1_epi32(wordLen == 4 ? -1 : static_cast<int>((1u << (8 * wordLen)) - 1));
+        const __m256i expected = _mm256_set1_epi32(static_cast<int>(word));
+        const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+        const char* values = reinterpret_cast<const char*>(first->value);
+        for (; i + 8 <= n; i += 8) {
+            const __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(values + i * stride), offsets, 1);
+            const __m256i equal = _mm256_cmpeq_epi32(_mm256_and_si256(words, mask), expected);
+            unsigned candidates = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+            while (candidates) {
+                const unsigned row = i + __builtin_ctz(candidates);
+                candidates &= candidates - 1;
+                const String& s = *reinterpret_cast<const String*>(base + row * stride);
+                if ((exact ? s.len == prefixLen : s.len >= prefixLen) && memcmp(s.value, prefix, prefixLen) == 0) {
+                    sel[count++] = row;
+                }
+            }
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        const String& s = *reinterpret_cast<const String*>(base + i * stride);
+        if ((exact ? s.len == prefixLen : s.len >= prefixLen) && memcmp(s.value, prefix, prefixLen) == 0) {
+            sel[count++] = i;
+        }
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------
+/// Rows whose string starts with the prefix (LIKE 'x%')
+template<class String>
+unsigned selectPrefix(const String* first, size_t stride, unsigned n, const char* prefix, unsigned prefixLen, uint32_t* sel)
+{
+    return selectPrefixImpl<false>(first, stride, n, prefix, prefixLen, sel);
+}
+
+//---------------------------------------------------------------------------
+/// Rows whose string equals the constant
+template<class String>
+unsigned selectEqual(const String* first, size_t stride, unsigned n, const char* other, unsigned otherLen, uint32_t* sel)
+{
+    return selectPrefixImpl<true>(first, stride, n, other, otherLen, sel);
+}
+
+//---------------------------------------------------------------------------
+/// Rows whose string ends with the suffix (LIKE '%x')
+template<class String>
+unsigned selectSuffix(const String* first, size_t stride, unsigned n, const char* suffix, unsigned suffixLen, uint32_t* sel)
+{
+    const char* base = reinterpret_cast<const char*>(first);
+    unsigned count = 0;
+    for (unsigned i = 0; i < n; i++) {
+        const String& s = *reinterpret_cast<const String*>(base + i * stride);
+        if (s.len >= suffixLen && memcmp(s.value + s.len - suffixLen, suffix, suffixLen) == 0) {
+            sel[count++] = i;
+        }
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------
+/// Rows whose string contains the needle (LIKE '%x%')
+template<class String>
+unsigned selectContains(const String* first, size_t stride, unsigned n, const char* needle, unsigned needleLen, uint32_t* sel)
+{
+    const char* base = reinterpret_cast<const char*>(first);
+    unsigned count = 0;
+    for (unsigned i = 0; i < n; i++) {
+        const String& s = *reinterpret_cast<const String*>(base + i * stride);
+        if (containsString(s.value, s.len, sizeof(s.value), needle, needleLen)) {
+            sel[count++] = i;
+        }
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------
+/// Rows matching a LIKE pattern, the pattern is only known at runtime
+template<class String>
+unsigned selectLike(const String* first, size_t stride, unsigned n, const char* pattern, unsigned patternLen, uint32_t* sel)
+{
+    // 'x', 'x%', '%x' and '%x%' without further wildcards in x have their own kernels
+    const bool leading = patternLen > 0 && pattern[0] == '%';
+    const bool trailing = patternLen > (leading ? 1u : 0u) && pattern[patternLen - 1] == '%';
+    const char* x = pattern + leading;
+    const unsigned xLen = patternLen - leading - trailing;
+    if (!memchr(x, '%', xLen) && !memchr(x, '_', xLen)) {
+        if (!leading && !trailing) { return selectEqual(first, stride, n, x, xLen, sel); }
+        if (!leading) { return selectPrefix(first, stride, n, x, xLen, sel); }
+        if (!trailing) { return selectSuffix(first, stride, n, x, xLen, sel); }
+        return selectContains(first, stride, n, x, xLen, sel);
+    }
+
+    const char* base = reinterpret_cast<const char*>(first);
+    unsigned count = 0;
+    for (unsigned i = 0; i < n; i++) {
+        const String& s = *reinterpret_cast<const String*>(base + i * stride);
+        if (likeMatch(s.value, s.len, pattern, patternLen)) {
+            sel[count++] = i;
+        }
+    }
+    return count;
+}
+
 //---------------------------------------------------------------------------
 static constexpr uint64_t numericShifts[19] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull, 10000000000ull, 100000000000ull,
                                                1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull};
@@ -717,9 +948,15 @@ public:
     /// Comparison
     bool operator<(const Timestamp& t) const { return value < t.value; }
 
+    /// Comparison
+    bool operator<=(const Timestamp& t) const { return value <= t.value; }
+
     /// Comparison
     bool operator>(const Timestamp& t) const { return value > t.value; }
 
+    /// Comparison
+    bool operator>=(const Timestamp& t) const { return value >= t.value; }
+
     /// Cast
     static Timestamp castString(const char* str, uint32_t strLen);
 };
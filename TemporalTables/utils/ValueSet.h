@@ -0,0 +1,56 @@
+#ifndef VALUE_SET_H
+#define VALUE_SET_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+// Set of the values of an IN list that is too long to compare with every value, see Selection
+//
+// The generated code builds it once per execution from the parameters of the list. The values are kept in a vector
+// and found through a directory of at least twice as many slots with linear probing, so a lookup hashes the value once
+// and usually compares it with one value. Duplicates in the list are stored once.
+template<typename T>
+class ValueSet {
+    std::vector<T> values;
+    /// Index of the value in a slot plus one, 0 is an empty slot
+    std::vector<uint32_t> directory;
+    uint64_t mask = 0;
+
+    /// The upper bits of the mixed hash are the best mixed ones
+    uint64_t slot(const T& value) const {
+        return ((value.hash() * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+    }
+
+public:
+    ValueSet(std::initializer_list<T> list) {
+        size_t capacity = 16;
+        while (capacity < 2 * list.size()) {
+            capacity *= 2;
+        }
+        directory.assign(capacity, 0);
+        mask = capacity - 1;
+        values.reserve(list.size());
+        for (auto& value : list) {
+            uint64_t i = slot(value);
+            while (directory[i] != 0 && !(values[directory[i] - 1] == value)) {
+                i = (i + 1) & mask;
+            }
+            if (directory[i] == 0) {
+                values.push_back(value);
+                directory[i] = (uint32_t) values.size();
+            }
+        }
+    }
+
+    bool contains(const T& value) const {
+        for (uint64_t i = slot(value); directory[i] != 0; i = (i + 1) & mask) {
+            if (values[directory[i] - 1] == value) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif //VALUE_SET_H
@@ -0,0 +1,96 @@
+#ifndef CHUNKED_VECTOR_H
+#define CHUNKED_VECTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include "page_allocator.h"
+
+/// An append-only vector that never relocates its elements.
+/// Rows are stored in fixed size chunks, so a reader thread may access any index below size() while the (single)
+/// writer keeps appending. The size is published with release semantics after the element has been constructed.
+/// The chunks come from the PageAllocator, so they follow the page policy of the database.
+template<typename T, unsigned chunkBits = 14>
+class ChunkedVector {
+    static constexpr size_t chunkSize = size_t(1) << chunkBits;
+    static constexpr size_t chunkMask = chunkSize - 1;
+    static constexpr size_t maxChunks = size_t(1) << 16;
+
+    /// The chunk directory, only entries below chunkCount are valid
+    T** chunks;
+    size_t chunkCount = 0;
+    std::atomic<size_t> count{0};
+
+    T* slot(size_t i) const { return chunks[i >> chunkBits] + (i & chunkMask); }
+
+    /// Make sure that the element at index i has backing memory
+    void reserveSlot(size_t i) {
+        while ((i >> chunkBits) >= chunkCount) {
+            if (chunkCount == maxChunks) {
+                throw "ChunkedVector: too many elements";
+            }
+            chunks[chunkCount] = static_cast<T*>(PageAllocator::allocate(chunkSize * sizeof(T)));
+            chunkCount++;
+        }
+    }
+
+public:
+    ChunkedVector() : chunks(new T* [maxChunks]) { }
+
+    ChunkedVector(const ChunkedVector&) = delete;
+
+    ChunkedVector& operator=(const ChunkedVector&) = delete;
+
+    ~ChunkedVector() {
+        const size_t n = size();
+        for (size_t i = 0; i < n; i++) {
+            slot(i)->~T();
+        }
+        for (size_t i = 0; i < chunkCount; i++) {
+            PageAllocator::deallocate(chunks[i], chunkSize * sizeof(T));
+        }
+        delete[] chunks;
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    bool empty() const { return size() == 0; }
+
+    T& operator[](size_t i) { return *slot(i); }
+
+    const T& operator[](size_t i) const { return *slot(i); }
+
+    T& back() { return *slot(size() - 1); }
+
+    void push_back(const T& element) {
+        const size_t n = count.load(std::memory_order_relaxed);
+        reserveSlot(n);
+        new(slot(n)) T(element);
+        count.store(n + 1, std::memory_order_release);
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&& ... args) {
+        const size_t n = count.load(std::memory_order_relaxed);
+        reserveSlot(n);
+        T* element = new(slot(n)) T(std::forward<Args>(args)...);
+        count.store(n + 1, std::memory_order_release);
+        return *element;
+    }
+
+    /// Only valid while no reader is accessing the last element
+    void pop_back() {
+        const size_t n = count.load(std::memory_order_relaxed) - 1;
+        count.store(n, std::memory_order_release);
+        slot(n)->~T();
+    }
+
+    void reserve(size_t n) {
+        if (n > 0) {
+            reserveSlot(n - 1);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,404 @@
+#ifndef MVCC_H
+#define MVCC_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <vector>
+
+// In-process snapshots for analytical queries (multi-version concurrency control)
+//
+// The single writer thread updates rows in place. Before it touches a row, it copies the words it is about to change
+// into the undo buffer of its transaction and links that before-image into the version chain of the row (newest first).
+// A reader works on a snapshot, the commit timestamp that was current when it started. Any entry with a newer timestamp
+// (or one that is not committed yet) is undone on a private copy of the row, so the reader sees the row as of its snapshot.
+// Committed undo entries that no active snapshot can need any more are unlinked and recycled by collectGarbage().
+// Rows deleted inside a transaction stay in their table as tombstones until then. Afterwards later inserts reuse their
+// slots, and the tables compact the rest in tryCompact() whenever no reader happens to have a snapshot.
+
+/// Header of a before-image, followed by `words` Word entries
+struct UndoEntry {
+    enum class Kind : uint32_t {
+        Update, Insert, Delete
+    };
+
+    /// A changed 4-byte word of the row and its previous value
+    struct Word {
+        uint32_t index;
+        uint32_t value;
+    };
+
+    /// Commit timestamp of the transaction that made the change, or its transaction id while not committed
+    std::atomic<uint64_t> ts;
+    /// The next older entry
+    std::atomic<UndoEntry*> next;
+    /// The version chain this entry is linked into
+    std::atomic<UndoEntry*>* chain;
+    Kind kind;
+    uint32_t words;
+
+    Word* begin() { return reinterpret_cast<Word*>(this + 1); }
+
+    const Word* begin() const { return reinterpret_cast<const Word*>(this + 1); }
+
+    const Word* end() const { return begin() + words; }
+};
+
+/// Per row version information, kept next to the table
+struct VersionSlot {
+    std::atomic<UndoEntry*> chain{nullptr};
+    std::atomic<bool> deleted{false};
+};
+
+/// A consistent read view of the database
+struct Snapshot {
+    uint64_t ts;
+    unsigned slot;
+};
+
+/// Undo buffer of one write transaction
+class Transaction {
+    friend class VersionManager;
+
+    static constexpr size_t blockSize = 64 * 1024;
+
+    uint64_t id = 0;
+    uint64_t commitTs = 0;
+    std::vector<UndoEntry*> entries;
+    std::vector<char*> blocks;
+    size_t blockUsed = blockSize;
+    size_t blockIndex = 0;
+
+    void* allocate(size_t bytes) {
+        bytes = (bytes + 7) & ~size_t(7);
+        if (blockUsed + bytes > blockSize) {
+            if (blockIndex == blocks.size()) {
+                blocks.push_back(new char[bytes > blockSize ? bytes : blockSize]);
+            }
+            blockIndex++;
+            blockUsed = 0;
+        }
+        char* result = blocks[blockIndex - 1] + blockUsed;
+        blockUsed += bytes;
+        return result;
+    }
+
+    /// Forget all entries but keep the memory for the next transaction
+    void reset() {
+        entries.clear();
+        blockIndex = 0;
+        blockUsed = blockSize;
+    }
+
+    UndoEntry* createEntry(UndoEntry::Kind kind, uint32_t words) {
+        auto entry = static_cast<UndoEntry*>(allocate(sizeof(UndoEntry) + words * sizeof(UndoEntry::Word)));
+        new(&entry->ts) std::atomic<uint64_t>(id);
+        new(&entry->next) std::atomic<UndoEntry*>(nullptr);
+        entry->kind = kind;
+        entry->words = words;
+        return entry;
+    }
+
+    /// Publish the entry as newest version of the row. Every write to the row itself has to happen afterwards.
+    void link(VersionSlot& slot, UndoEntry* entry) {
+        entry->chain = &slot.chain;
+        entry->next.store(slot.chain.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        slot.chain.store(entry, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        entries.push_back(entry);
+    }
+
+    static uint32_t loadWord(const char* data, size_t offset, size_t bytes) {
+        uint32_t word = 0;
+        memcpy(&word, data + offset, bytes - offset < 4 ? bytes - offset : 4);
+        return word;
+    }
+
+public:
+    Transaction() = default;
+
+    Transaction(const Transaction&) = delete;
+
+    ~Transaction() {
+        for (auto block : blocks) {
+            delete[] block;
+        }
+    }
+
+    /// Keep the words of `before` that differ in `after`
+    void logUpdate(VersionSlot& slot, const void* before, const void* after, size_t bytes) {
+        auto oldData = static_cast<const char*>(before);
+        auto newData = static_cast<const char*>(after);
+        uint32_t changed = 0;
+        for (size_t offset = 0; offset < bytes; offset += 4) {
+            changed += loadWord(oldData, offset, bytes) != loadWord(newData, offset, bytes);
+        }
+        if (changed == 0) {
+            return;
+        }
+
+        UndoEntry* entry = createEntry(UndoEntry::Kind::Update, changed);
+        UndoEntry::Word* word = entry->begin();
+        for (size_t offset = 0; offset < bytes; offset += 4) {
+            uint32_t oldWord = loadWord(oldData, offset, bytes);
+            if (oldWord != loadWord(newData, offset, bytes)) {
+                *word++ = {static_cast<uint32_t>(offset / 4), oldWord};
+            }
+        }
+        link(slot, entry);
+    }
+
+    /// The row did not exist before this transaction
+    void logInsert(VersionSlot& slot) {
+        link(slot, createEntry(UndoEntry::Kind::Insert, 0));
+    }
+
+    /// Mark the row deleted, older snapshots still see it
+    void logDelete(VersionSlot& slot) {
+        link(slot, createEntry(UndoEntry::Kind::Delete, 0));
+        slot.deleted.store(true, std::memory_order_relaxed);
+    }
+};
+
+/// Hands out snapshots and timestamps, and recycles undo buffers nobody can see anymore
+class VersionManager {
+    static constexpr unsigned maxReaders = 64;
+    static constexpr uint64_t slotFree = std::numeric_limits<uint64_t>::max();
+    static constexpr uint64_t slotBusy = slotFree - 1;
+    static constexpr uint64_t uncommitted = uint64_t(1) << 63;
+
+    struct alignas(64) Reader {
+        std::atomic<uint64_t> ts{slotFree};
+        std::atomic<uint64_t> epoch{0};
+    };
+
+    std::atomic<uint64_t> lastCommitted{0};
+    std::atomic<uint64_t> epoch{0};
+    /// Rows are moved, new snapshots wait until it is done
+    std::atomic<bool> compacting{false};
+    Reader readers[maxReaders];
+
+    Transaction* activeTx = nullptr;
+    uint64_t nextTxId = 1;
+    /// Committed transactions that still have entries in the version chains, in commit order
+    std::deque<Transaction*> committed;
+    /// Unlinked transactions, which may still be visited by readers that started before the given epoch
+    std::deque<std::pair<uint64_t, Transaction*>> retired;
+    std::vector<Transaction*> pool;
+
+    static void unlink(UndoEntry* entry) {
+        // Older entries have been unlinked before, so this is the last entry in the chain
+        UndoEntry* current = entry->chain->load(std::memory_order_relaxed);
+        if (current == entry) {
+            entry->chain->store(nullptr, std::memory_order_release);
+            return;
+        }
+        while (current->next.load(std::memory_order_relaxed) != entry) {
+            current = current->next.load(std::memory_order_relaxed);
+        }
+        current->next.store(nullptr, std::memory_order_release);
+    }
+
+public:
+    VersionManager() = default;
+
+    VersionManager(const VersionManager&) = delete;
+
+    ~VersionManager() {
+        delete activeTx;
+        for (auto tx : committed) {
+            delete tx;
+        }
+        for (auto& e : retired) {
+            delete e.second;
+        }
+        for (auto tx : pool) {
+            delete tx;
+        }
+    }
+
+    /// The transaction of the writer, nullptr if writes should not be versioned
+    Transaction* active() const { return activeTx; }
+
+    /// Start a write transaction, there is only one writer at a time
+    Transaction& begin() {
+        if (pool.empty()) {
+            activeTx = new Transaction();
+        } else {
+            activeTx = pool.back();
+            pool.pop_back();
+        }
+        activeTx->id = uncommitted | nextTxId++;
+        return *activeTx;
+    }
+
+    /// Make the changes of the active transaction visible to new snapshots
+    void commit() {
+        const uint64_t ts = lastCommitted.load(std::memory_order_relaxed) + 1;
+        activeTx->commitTs = ts;
+        for (auto entry : activeTx->entries) {
+            entry->ts.store(ts, std::memory_order_release);
+        }
+        lastCommitted.store(ts, std::memory_order_seq_cst);
+
+        if (activeTx->entries.empty()) {
+            activeTx->reset();
+            pool.push_back(activeTx);
+        } else {
+            committed.push_back(activeTx);
+        }
+        activeTx = nullptr;
+    }
+
+    /// Register a reader, the snapshot has to be released again
+    Snapshot snapshot() {
+        for (unsigned i = 0; i < maxReaders; i++) {
+            uint64_t expected = slotFree;
+            if (!readers[i].ts.compare_exchange_strong(expected, slotBusy)) {
+                continue;
+            }
+            if (compacting.load()) { // The slot has to be given back, tryCompact() only runs without readers
+                readers[i].ts.store(slotFree);
+                while (compacting.load()) {
+                    std::this_thread::yield();
+                }
+                i = -1u; // Start over at the first slot
+                continue;
+            }
+            readers[i].epoch.store(epoch.load());
+            uint64_t ts;
+            do { // The writer might commit and collect garbage in between
+                ts = lastCommitted.load();
+                readers[i].ts.store(ts);
+            } while (ts != lastCommitted.load());
+            return Snapshot{ts, i};
+        }
+        throw "Too many concurrent snapshots";
+    }
+
+    void release(const Snapshot& snapshot) {
+        readers[snapshot.slot].ts.store(slotFree, std::memory_order_release);
+    }
+
+    /// Unlink all before-images that no active snapshot needs, called by the writer between transactions
+    void collectGarbage() {
+        uint64_t minTs = lastCommitted.load();
+        uint64_t minEpoch = slotFree;
+        for (auto& reader : readers) {
+            uint64_t ts = reader.ts.load();
+            if (ts == slotFree) {
+                continue;
+            }
+            if (ts < minTs) {
+                minTs = ts;
+            }
+            uint64_t readerEpoch = reader.epoch.load();
+            if (readerEpoch < minEpoch) {
+                minEpoch = readerEpoch;
+            }
+        }
+
+        // Readers that registered after the entries have been unlinked cannot reach them anymore
+        while (!retired.empty() && retired.front().first < minEpoch) {
+            Transaction* tx = retired.front().second;
+            retired.pop_front();
+            tx->reset();
+            pool.push_back(tx);
+        }
+
+        if (committed.empty() || committed.front()->commitTs > minTs) {
+            return;
+        }
+        const uint64_t currentEpoch = epoch.fetch_add(1) + 1;
+        while (!committed.empty() && committed.front()->commitTs <= minTs) {
+            Transaction* tx = committed.front();
+            committed.pop_front();
+            for (auto entry : tx->entries) {
+                unlink(entry);
+            }
+            retired.emplace_back(currentEpoch, tx);
+        }
+    }
+
+    /// Run f if no reader has a snapshot, so that it can move rows. Called by the writer between transactions after
+    /// collectGarbage(). The writer never waits for readers: if any is active, f is skipped and false is returned.
+    template<typename F>
+    bool tryCompact(F&& f) {
+        compacting.store(true);
+        for (auto& reader : readers) {
+            if (reader.ts.load() != slotFree) {
+                compacting.store(false);
+                return false;
+            }
+        }
+        f();
+        compacting.store(false);
+        return true;
+    }
+};
+
+/// Move the version information of a row to another slot, only while no reader has a snapshot
+inline void moveVersion(VersionSlot& from, VersionSlot& to) {
+    UndoEntry* chain = from.chain.load(std::memory_order_relaxed);
+    to.chain.store(chain, std::memory_order_relaxed);
+    to.deleted.store(from.deleted.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    for (UndoEntry* entry = chain; entry != nullptr; entry = entry->next.load(std::memory_order_relaxed)) {
+        entry->chain = &to.chain;
+    }
+}
+
+/// Call f with the row as it was visible to the snapshot. Returns false if the row did not exist for the snapshot.
+/// f might be called more than once if the writer changes the row concurrently, so it should only copy values out.
+template<typename Row, typename F>
+bool readVersion(const Row& row, const VersionSlot& slot, const Snapshot& snapshot, F&& f) {
+    while (true) {
+        UndoEntry* head = slot.chain.load(std::memory_order_acquire);
+        if (head == nullptr || head->ts.load(std::memory_order_acquire) <= snapshot.ts) {
+            // Fast path: the row has not been changed since the snapshot was taken
+            bool visible = !slot.deleted.load(std::memory_order_relaxed);
+            if (visible) {
+                f(row);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.chain.load(std::memory_order_relaxed) == head) {
+                return visible;
+            }
+            continue;
+        }
+
+        // Undo all newer changes on a copy of the row
+        alignas(Row) char copy[sizeof(Row)];
+        memcpy(copy, &row, sizeof(Row));
+        bool visible = !slot.deleted.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.chain.load(std::memory_order_relaxed) != head) {
+            continue;
+        }
+        for (const UndoEntry* entry = head; entry != nullptr && entry->ts.load(std::memory_order_acquire) > snapshot.ts;
+             entry = entry->next.load(std::memory_order_acquire)) {
+            switch (entry->kind) {
+                case UndoEntry::Kind::Update:
+                    for (auto word = entry->begin(); word != entry->end(); ++word) {
+                        size_t offset = word->index * size_t(4);
+                        memcpy(copy + offset, &word->value, sizeof(Row) - offset < 4 ? sizeof(Row) - offset : 4);
+                    }
+                    break;
+                case UndoEntry::Kind::Insert:
+                    visible = false;
+                    break;
+                case UndoEntry::Kind::Delete:
+                    visible = true;
+                    break;
+            }
+        }
+        if (visible) {
+            f(*reinterpret_cast<const Row*>(copy));
+        }
+        return visible;
+    }
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef OBSERVER_H
+#define OBSERVER_H
+
+#include <algorithm>
+#include <vector>
+
+// Change notifications for materialized views
+//
+// A view registers a TableObserver with every table its query reads. The tables call it on each insert, update and
+// remove made through their interface, so the view can apply the difference instead of recomputing the query.
+// Bulk loading with append() is not reported, views compute their initial state from the loaded tables.
+
+/// Gets told about every change to a table
+template<typename Row>
+class TableObserver {
+public:
+    virtual ~TableObserver() = default;
+
+    /// Called after the row has been inserted
+    virtual void inserted(const Row& row) = 0;
+
+    /// Called with a copy of the old row, the table already contains the new one
+    virtual void updated(const Row& before, const Row& after) = 0;
+
+    /// Called before the row is removed
+    virtual void removed(const Row& row) = 0;
+};
+
+/// The observers of one table, cheap to check if nothing is registered
+template<typename Row>
+class Observers {
+    std::vector<TableObserver<Row>*> observers;
+
+public:
+    void add(TableObserver<Row>* observer) { observers.push_back(observer); }
+
+    void remove(TableObserver<Row>* observer) {
+        observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+    }
+
+    bool empty() const { return observers.empty(); }
+
+    void inserted(const Row& row) {
+        for (auto observer : observers) {
+            observer->inserted(row);
+        }
+    }
+
+    void updated(const Row& before, const Row& after) {
+        for (auto observer : observers) {
+            observer->updated(before, after);
+        }
+    }
+
+    void removed(const Row& row) {
+        for (auto observer : observers) {
+            observer->removed(row);
+        }
+    }
+};
+
+#endif
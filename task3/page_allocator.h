@@ -0,0 +1,169 @@
+#ifndef PAGE_ALLOCATOR_H
+#define PAGE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <sys/mman.h>
+
+// Memory for the table storage and the indexes
+//
+// With the default policy memory comes from operator new. The other policies map memory in multiples of 2MB, either
+// as transparent huge pages (madvise) or from the huge page pool of the kernel (MAP_HUGETLB). Huge pages make the page
+// tables 512 times smaller, so fork() has less to copy and scans cause fewer TLB misses.
+
+/// Which pages back the table storage
+enum class PagePolicy {
+    Default, TransparentHuge, HugeTLB
+};
+
+/// Options for the storage of a database, passed to its constructor
+struct StorageOptions {
+    PagePolicy pages = PagePolicy::Default;
+
+    /// Parse "default", "thp" or "hugetlb"
+    static PagePolicy parsePages(const std::string& name) {
+        if (name == "default") { return PagePolicy::Default; }
+        if (name == "thp") { return PagePolicy::TransparentHuge; }
+        if (name == "hugetlb") { return PagePolicy::HugeTLB; }
+        throw "Unknown page policy, expected default, thp or hugetlb";
+    }
+};
+
+class PageAllocator {
+    static constexpr size_t hugePageSize = size_t(2) << 20;
+    /// Blocks below a huge page are rounded to this granularity and recycled in free lists per size
+    static constexpr size_t granularity = 16;
+
+    struct State {
+        PagePolicy policy = PagePolicy::Default;
+        bool hugeTLBFailed = false;
+        char* arena = nullptr;
+        size_t arenaLeft = 0;
+        std::unordered_map<size_t, void*> freeLists;
+        /// Blocks allocated and not yet returned, deallocate relies on them all following the current policy
+        size_t live = 0;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static size_t roundUp(size_t bytes, size_t to) { return (bytes + to - 1) / to * to; }
+
+    static void* mapPages(size_t bytes) {
+        State& s = state();
+        if (s.policy == PagePolicy::HugeTLB && !s.hugeTLBFailed) {
+            void* result = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (result != MAP_FAILED) {
+                return result;
+            }
+            // The huge page pool is empty or not configured, use transparent huge pages from now on
+            s.hugeTLBFailed = true;
+        }
+
+        // Over-allocate to align the mapping to 2MB, so that all of it can be backed by huge pages
+        void* raw = mmap(nullptr, bytes + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = roundUp(begin, hugePageSize);
+        if (aligned != begin) {
+            munmap(raw, aligned - begin);
+        }
+        munmap(reinterpret_cast<void*>(aligned + bytes), begin + hugePageSize - aligned);
+        madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+public:
+    /// Set the policy while no table memory is allocated, a second database may only differ once the first is gone
+    static void setPolicy(PagePolicy policy) {
+        State& s = state();
+        if (policy != s.policy && s.live > 0) {
+            throw "Cannot change the page policy while memory of another policy is allocated";
+        }
+        s.policy = policy;
+    }
+
+    static PagePolicy policy() { return state().policy; }
+
+    /// True if MAP_HUGETLB was requested but the kernel had no huge pages to give
+    static bool hugeTLBFailed() { return state().hugeTLBFailed; }
+
+    /// Blocks of at least a huge page are mapped on their own, smaller ones are carved from huge page backed arenas.
+    /// Not thread safe: only the writer allocates table chunks and index nodes.
+    static void* allocate(size_t bytes) {
+        State& s = state();
+        if (s.policy == PagePolicy::Default) {
+            void* result = ::operator new(bytes);
+            s.live++;
+            return result;
+        }
+        if (bytes >= hugePageSize) {
+            void* result = mapPages(roundUp(bytes, hugePageSize));
+            s.live++;
+            return result;
+        }
+
+        bytes = roundUp(bytes, granularity);
+        void*& freeList = s.freeLists[bytes];
+        if (freeList) {
+            void* result = freeList;
+            freeList = *static_cast<void**>(result);
+            s.live++;
+            return result;
+        }
+        if (s.arenaLeft < bytes) {
+            // The rest of the old arena is lost, arenas are never returned
+            s.arena = static_cast<char*>(mapPages(hugePageSize));
+            s.arenaLeft = hugePageSize;
+        }
+        void* result = s.arena;
+        s.arena += bytes;
+        s.arenaLeft -= bytes;
+        s.live++;
+        return result;
+    }
+
+    static void deallocate(void* p, size_t bytes) {
+        State& s = state();
+        s.live--;
+        if (s.policy == PagePolicy::Default) {
+            ::operator delete(p);
+        } else if (bytes >= hugePageSize) {
+            munmap(p, roundUp(bytes, hugePageSize));
+        } else {
+            void*& freeList = s.freeLists[roundUp(bytes, granularity)];
+            *static_cast<void**>(p) = freeList;
+            freeList = p;
+        }
+    }
+};
+
+/// STL allocator for the index structures, following the policy of the PageAllocator
+template<typename T>
+struct IndexAllocator {
+    using value_type = T;
+
+    IndexAllocator() = default;
+
+    template<typename U>
+    IndexAllocator(const IndexAllocator<U>&) { }
+
+    T* allocate(size_t n) { return static_cast<T*>(PageAllocator::allocate(n * sizeof(T))); }
+
+    void deallocate(T* p, size_t n) { PageAllocator::deallocate(p, n * sizeof(T)); }
+
+    template<typename U>
+    bool operator==(const IndexAllocator<U>&) const { return true; }
+
+    template<typename U>
+    bool operator!=(const IndexAllocator<U>&) const { return false; }
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Building blocks for morsel-driven query execution
+//
+// A pipeline is split into morsels of consecutive rows. The workers of a ThreadPool grab the next morsel from a shared
+// counter until the input is exhausted, so fast workers simply process more morsels. Hash joins are built in two
+// phases: every worker first collects its matching tuples locally, then all of them are linked into a
+// ConcurrentHashTable of the exact size with a compare-and-swap on the bucket heads.
+
+/// A fixed set of worker threads, the thread calling run() takes part as worker 0
+class ThreadPool {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(unsigned)>* job = nullptr;
+    uint64_t generation = 0;
+    unsigned running = 0;
+    bool stop = false;
+
+    void work(unsigned worker) {
+        uint64_t seen = 0;
+        while (true) {
+            const std::function<void(unsigned)>* current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stop || generation != seen; });
+                if (stop) {
+                    return;
+                }
+                seen = generation;
+                current = job;
+            }
+            (*current)(worker);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--running == 0) {
+                    finished.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    /// Rows per morsel, one chunk of the table storage
+    static constexpr size_t morselSize = 16 * 1024;
+
+    explicit ThreadPool(unsigned workers) {
+        for (unsigned i = 1; i < workers; i++) {
+            threads.emplace_back(&ThreadPool::work, this, i);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    /// Number of workers, including the calling thread
+    unsigned size() const { return static_cast<unsigned>(threads.size()) + 1; }
+
+    /// Run f(worker) on every worker and wait until all of them are done
+    void run(const std::function<void(unsigned)>& f) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &f;
+            running = static_cast<unsigned>(threads.size());
+            generation++;
+        }
+        wake.notify_all();
+        f(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return running == 0; });
+    }
+
+    /// Call f(begin, end, worker) for morsels of the range [0, n)
+    template<typename F>
+    void parallelFor(size_t n, F&& f, size_t morsel = morselSize) {
+        std::atomic<size_t> next{0};
+        run([&](unsigned worker) {
+            while (true) {
+                const size_t begin = next.fetch_add(morsel);
+                if (begin >= n) {
+                    return;
+                }
+                f(begin, std::min(begin + morsel, n), worker);
+            }
+        });
+    }
+};
+
+/// Hash table for joins that many threads can insert into at the same time, its size has to be known up front
+template<typename Key, typename Value>
+class ConcurrentHashTable {
+public:
+    struct Entry {
+        Entry* next;
+        size_t hash;
+        Key key;
+        Value value;
+    };
+
+private:
+    std::unique_ptr<std::atomic<Entry*>[]> buckets;
+    size_t mask = 0;
+
+    static size_t hashKey(const Key& key) {
+        // Spread the combined hash of the key over the upper bits as well
+        return std::hash<Key>()(key) * 0x9e3779b97f4a7c15ull;
+    }
+
+public:
+    /// Allocate the directory for n entries, not thread safe
+    void setSize(size_t n) {
+        size_t capacity = 16;
+        while (capacity < 2 * n) {
+            capacity *= 2;
+        }
+        buckets.reset(new std::atomic<Entry*>[capacity]);
+        for (size_t i = 0; i < capacity; i++) {
+            buckets[i].store(nullptr, std::memory_order_relaxed);
+        }
+        mask = capacity - 1;
+    }
+
+    static Entry makeEntry(const Key& key, const Value& value) { return Entry{nullptr, hashKey(key), key, value}; }
+
+    /// Link the entry into its bucket, the entry has to stay alive as long as the table
+    void insert(Entry* entry) {
+        std::atomic<Entry*>& head = buckets[(entry->hash >> 16) & mask];
+        Entry* old = head.load(std::memory_order_relaxed);
+        do {
+            entry->next = old;
+        } while (!head.compare_exchange_weak(old, entry, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /// Look up a key after all inserts have finished, nullptr if it is not in the table
+    const Value* find(const Key& key) const {
+        const size_t hash = hashKey(key);
+        for (Entry* entry = buckets[(hash >> 16) & mask].load(std::memory_order_acquire); entry; entry = entry->next) {
+            if (entry->hash == hash && entry->key == key) {
+                return &entry->value;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/// Per worker state, padded so that workers do not share cache lines
+template<typename T>
+struct alignas(64) WorkerLocal {
+    T value{};
+};
+
+#endif
@@ -87,8 +87,14 @@ string Schema::generateDatabaseCode() const {
         << "#include <unordered_map>" << endl
         << "#include <tuple>" << endl
         << "#include <map>" << endl
+        << "#include <algorithm>" << endl
+        << "#include <functional>" << endl
         << "#include \"Types.hpp\"" << endl
-        << "#include \"tupel_hash.h\"" << endl;
+        << "#include \"tupel_hash.h\"" << endl
+        << "#include \"page_allocator.h\"" << endl
+        << "#include \"chunked_vector.h\"" << endl
+        << "#include \"mvcc.h\"" << endl
+        << "#include \"observer.h\"" << endl;
 
 
     out << "struct Database {" << endl;
@@ -123,11 +129,18 @@ string Schema::generateDatabaseCode() const {
         out << "            return ret;" << endl;
         out << "        }" << endl;
 
-        //Add the most important table vars
-        out << "        std::vector<Row> table{};" << endl;
+        //Add the most important table vars, rows never move so that snapshot readers can scan them concurrently
+        out << "        ChunkedVector<Row> table{};" << endl;
+        out << "        ChunkedVector<VersionSlot> versions{};" << endl;
+        out << "        VersionManager* mvcc = nullptr;" << endl;
+        out << "        Observers<Row> observers{};" << endl;
+        out << "        /// Rows deleted by transactions, which older snapshots may still see" << endl;
+        out << "        std::vector<size_t> tombstones{};" << endl;
+        out << "        /// Tombstones no snapshot can see anymore, inserts reuse them" << endl;
+        out << "        std::vector<size_t> freeSlots{};" << endl;
         if (hasPK) {
-            out << "        std::unordered_map<pkType, u_int32_t> pk{};" << endl;
-            out << "        std::map<pkType, u_int32_t> pkTree{};" << endl;
+            out << "        std::unordered_map<pkType, u_int32_t, std::hash<pkType>, std::equal_to<pkType>, IndexAllocator<std::pair<const pkType, u_int32_t>>> pk{};" << endl;
+            out << "        std::map<pkType, u_int32_t, std::less<pkType>, IndexAllocator<std::pair<const pkType, u_int32_t>>> pkTree{};" << endl;
         }
         if (rel.indexes.size() > 0) {
             for (auto e : rel.indexes) {
@@ -142,38 +155,111 @@ string Schema::generateDatabaseCode() const {
             out << "        Row& row(pkType k) { return table[pk[k]]; }" << endl;
         }
         out << "        Row& row(size_t i) { return table[i]; }" << endl;
+        out << "        Transaction* transaction() { return mvcc ? mvcc->active() : nullptr; }" << endl;
+
+        //Reading a row as of a snapshot, the row might not be visible at all
+        out << "        template<typename F>" << endl;
+        out << "        bool read(size_t i, const Snapshot& snapshot, F&& f) { return readVersion(table[i], versions[i], snapshot, f); }" << endl;
 
         if (hasPK) { //Don't allow updating rows, if the table does not have a PK
-            out << "        void update(Row& element) { table[pk[element.key()]] = element; }" << endl;
+            out << "        void update(const Row& element) {" << endl;
+            out << "            const auto i = pk[element.key()];" << endl;
+            out << "            if (Transaction* tx = transaction()) {" << endl;
+            out << "                tx->logUpdate(versions[i], &table[i], &element, sizeof(Row));" << endl;
+            out << "            }" << endl;
+            out << "            if (observers.empty()) {" << endl;
+            out << "                table[i] = element;" << endl;
+            out << "                return;" << endl;
+            out << "            }" << endl;
+            out << "            const Row before = table[i];" << endl;
+            out << "            table[i] = element;" << endl;
+            out << "            observers.updated(before, element);" << endl;
+            out << "        }" << endl;
         }
 
-        //Removing elements
+        //Removing elements: inside a transaction the row stays as tombstone for older snapshots
         out << "        void remove(size_t i) {" << endl;
+        out << "            observers.removed(table[i]);" << endl;
         if (hasPK) {
-            //out << "            const auto key = row(i).key();" << endl;
-            //out << "            pk.erase(key);" << endl;
-            //out << "            pkTree.erase(key);" << endl;
             out << "            const auto key = row(i).key();" << endl;
             out << "            pk.erase(key);" << endl;
             out << "            pkTree.erase(key);" << endl;
-
         }
-        //out << "            table[i] = row(table.size()-1);" << endl;
-        out << "            std::iter_swap(table.begin() +i, table.end()-1);\n";
-        out << "            table.pop_back();" << endl;
+        out << "            if (Transaction* tx = transaction()) {" << endl;
+        out << "                tx->logDelete(versions[i]);" << endl;
+        out << "                tombstones.push_back(i);" << endl;
+        out << "                return;" << endl;
+        out << "            }" << endl;
+        out << "            moveLast(i);" << endl;
+        out << "            std::replace(tombstones.begin(), tombstones.end(), table.size(), i);" << endl;
+        out << "            std::replace(freeSlots.begin(), freeSlots.end(), table.size(), i);" << endl;
+        out << "        }" << endl;
+
+        //Replacing a row by the last one, which keeps its versions
+        out << "        void moveLast(size_t i) {" << endl;
+        out << "            const size_t last = table.size() - 1;" << endl;
+        out << "            if (i != last) {" << endl;
+        out << "                table[i] = table[last];" << endl;
+        out << "                moveVersion(versions[last], versions[i]);" << endl;
         if (hasPK) {
-            out << "            pk[table[i].key()] = i;" << endl;
-            out << "            pkTree[table[i].key()] = i;" << endl;
+            out << "                if (!versions[i].deleted.load(std::memory_order_relaxed)) {" << endl;
+            out << "                    pk[table[i].key()] = i;" << endl;
+            out << "                    pkTree[table[i].key()] = i;" << endl;
+            out << "                }" << endl;
         }
+        out << "            }" << endl;
+        out << "            table.pop_back();" << endl;
+        out << "            versions.pop_back();" << endl;
+        out << "        }" << endl;
+
+        //The version chain of a tombstone is unlinked once its delete is older than all snapshots
+        out << "        void reclaim() {" << endl;
+        out << "            auto seen = std::partition(tombstones.begin(), tombstones.end(), [this](size_t i) {" << endl;
+        out << "                return versions[i].chain.load(std::memory_order_relaxed) != nullptr;" << endl;
+        out << "            });" << endl;
+        out << "            freeSlots.insert(freeSlots.end(), seen, tombstones.end());" << endl;
+        out << "            tombstones.erase(seen, tombstones.end());" << endl;
+        out << "        }" << endl;
+        out << "        bool hasGarbage() const { return !freeSlots.empty(); }" << endl;
+        out << "        /// Remove the free slots, only while there are no readers (VersionManager::tryCompact)" << endl;
+        out << "        void compact() {" << endl;
+        out << "            std::sort(freeSlots.begin(), freeSlots.end(), std::greater<size_t>());" << endl;
+        out << "            for (size_t i : freeSlots) {" << endl;
+        out << "                //The last row is live or a tombstone, all higher free slots are gone" << endl;
+        out << "                moveLast(i);" << endl;
+        out << "                std::replace(tombstones.begin(), tombstones.end(), table.size(), i);" << endl;
+        out << "            }" << endl;
+        out << "            freeSlots.clear();" << endl;
         out << "        }" << endl;
 
         //Inserting
+        out << "        void append(const Row& element) {" << endl;
+        out << "            versions.emplace_back();" << endl;
+        out << "            table.push_back(element);" << endl;
+        out << "        }" << endl;
         out << "        void insert(const Row& element) { " << endl;
-        out << "            table.push_back(element); " << endl;
+        out << "            size_t i = table.size();" << endl;
+        out << "            if (freeSlots.empty()) {" << endl;
+        out << "                versions.emplace_back();" << endl;
+        out << "            } else {" << endl;
+        out << "                //Readers may still scan the slot, the insert entry tells them the row is too new" << endl;
+        out << "                i = freeSlots.back();" << endl;
+        out << "                freeSlots.pop_back();" << endl;
+        out << "            }" << endl;
+        out << "            if (Transaction* tx = transaction()) {" << endl;
+        out << "                tx->logInsert(versions[i]);" << endl;
+        out << "            }" << endl;
+        out << "            versions[i].deleted.store(false, std::memory_order_relaxed);" << endl;
+        out << "            if (i == table.size()) {" << endl;
+        out << "                table.push_back(element);" << endl;
+        out << "            } else {" << endl;
+        out << "                table[i] = element;" << endl;
+        out << "            }" << endl;
         if (hasPK) {
-            out << "            pk[element.key()] = table.size() - 1;" << endl;
-            out << "            pkTree[element.key()] = table.size() - 1;" << endl;
+            out << "            pk[element.key()] = i;" << endl;
+            out << "            pkTree[element.key()] = i;" << endl;
         }
+        out << "            observers.inserted(element);" << endl;
         out << "        }" << endl;
         if (hasPK) {
             out << "        void buildIndex() {" << endl;
@@ -213,22 +299,54 @@ string Schema::generateDatabaseCode() const {
             "        while (getline(myfile, line)) {\n"
             "            split(line, lineChunks);\n"
             "            auto tmp = T::parse(lineChunks);\n"
-            "            tbl.table.push_back(tmp);\n"
+            "            tbl.append(tmp);\n"
             "        }\n"
             "        myfile.close();\n"
             "    }" << endl;
 
     out << "public: " << endl;
-    out << "    Database(const Database&) = delete;\n"
-            "    Database () {}" << endl;
+    out << "    /// Versioning of all tables, writes are only versioned while a transaction is active" << endl;
+    out << "    VersionManager mvcc;" << endl;
     for (const Schema::Relation &rel : relations) {
         out << "    " << rel.name << " " << rel.name << ";" << endl;
     }
+    out << "    Database(const Database&) = delete;" << endl;
+
+    //Garbage collection of the versions and then of the rows they deleted
+    out << "    /// Recycle the versions no snapshot needs and reuse the slots of the rows deleted by them, called by the writer" << endl;
+    out << "    /// between transactions. The free slots are compacted when no reader is active, the writer never waits for one" << endl;
+    out << "    void collectGarbage() {" << endl;
+    out << "        mvcc.collectGarbage();" << endl;
+    for (const Schema::Relation &rel : relations) {
+        out << "        " << rel.name << ".reclaim();" << endl;
+    }
+    out << "        if (";
+    for (size_t i = 0; i < relations.size(); i++) {
+        out << (i > 0 ? " || " : "") << relations[i].name << ".hasGarbage()";
+    }
+    out << ") {" << endl;
+    out << "            mvcc.tryCompact([this] {" << endl;
+    for (const Schema::Relation &rel : relations) {
+        out << "                " << rel.name << ".compact();" << endl;
+    }
+    out << "            });" << endl;
+    out << "        }" << endl;
+    out << "    }" << endl;
+    out << "    /// The tables do not allocate memory before their first insert, so the page policy applies to all of it" << endl;
+    out << "    explicit Database(const StorageOptions& options = StorageOptions()) {" << endl;
+    out << "        PageAllocator::setPolicy(options.pages);" << endl;
+    for (const Schema::Relation &rel : relations) {
+        out << "        " << rel.name << ".mvcc = &mvcc;" << endl;
+    }
+    out << "    }" << endl;
 
     //Import: import any data into our database
     out << "    void import(const std::string &path) {" << endl;
     for (const Schema::Relation &rel : relations) {
         out << "       loadTableFromFile(" << rel.name << ", path + \"tpcc_" << rel.name << ".tbl\");\n" << endl;
+        if (rel.primaryKey.size() > 0) {
+            out << "       " << rel.name << ".buildIndex();" << endl;
+        }
         out << "       std::cout << \"\\t" << rel.name << ": \" << " << rel.name << ".size() << std::endl;" << endl;
     }
     out << "    }" << endl; // End import()
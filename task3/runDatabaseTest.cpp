@@ -10,13 +10,21 @@
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <chrono>
 #include <memory>
+#include <thread>
+#include <algorithm>
+#include <iomanip>
+#include <type_traits>
+#include <random>
 
 #include "parser/Parser.hpp"
 #include "parser/Schema.hpp"
 #include "db.h"
+#include "parallel.h"
+#include "observer.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -134,6 +142,7 @@ void delivery(Database* db, Integer w_id, Integer o_carrier_id, Timestamp dateti
 
         auto customer = db->customer.row(std::make_tuple(w_id, d_id, o_c_id));
         customer.c_balance = customer.c_balance + ol_total.castS<12>();
+        db->customer.update(customer);
     }
 }
 
@@ -219,16 +228,360 @@ Numeric<12, 4> statSum(Database* db) {
     return sum;
 }
 
-static void runQuery(Database* db, int iterations) {
-    int totalSeconds = 0;
-    Numeric<12, 4> result;
+/// Parallel version of statSum, read(table, i, f) calls f with row i if it is visible to the query.
+/// If all rows are read in place, the filter kernels can scan the columns directly.
+template<typename Read>
+Numeric<12, 4> statSum(Database* db, ThreadPool& pool, Read&& read, bool inPlace) {
+    using Key = std::tuple<Integer, Integer, Integer>;
+
+    // c_id, c_d_id, c_w_id -> c_balance
+    ConcurrentHashTable<Key, Numeric<12, 2>> customers;
+    std::vector<WorkerLocal<std::vector<decltype(customers)::Entry>>> customerEntries(pool.size());
+    pool.parallelFor(db->customer.size(), [&](size_t begin, size_t end, unsigned worker) {
+        auto& entries = customerEntries[worker].value;
+        if (inPlace) {
+            // A morsel never spans two chunks of the table, so its rows are contiguous
+            uint32_t sel[ThreadPool::morselSize];
+            const auto& first = db->customer.row(begin);
+            const unsigned count = selectPrefix(&first.c_last, sizeof(first), end - begin, "B", 1, sel); // c_last like 'B%'
+            for (unsigned s = 0; s < count; s++) {
+                const auto& row = db->customer.row(begin + sel[s]);
+                entries.push_back(customers.makeEntry(std::make_tuple(row.c_id, row.c_d_id, row.c_w_id), row.c_balance));
+            }
+            return;
+        }
+        for (size_t i = begin; i < end; i++) {
+            Key key;
+            Numeric<12, 2> c_balance;
+            bool selected = false;
+            read(db->customer, i, [&](const auto& row) {
+                key = std::make_tuple(row.c_id, row.c_d_id, row.c_w_id);
+                c_balance = row.c_balance;
+                selected = row.c_last.value[0] == 'B'; // c_last like 'B%'
+            });
+            if (selected) {
+                entries.push_back(customers.makeEntry(key, c_balance));
+            }
+        }
+    });
+    size_t customerCount = 0;
+    for (auto& entries : customerEntries) {
+        customerCount += entries.value.size();
+    }
+    customers.setSize(customerCount);
+    pool.parallelFor(customerEntries.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; i++) {
+            for (auto& entry : customerEntries[i].value) {
+                customers.insert(&entry);
+            }
+        }
+    }, 1);
+
+    // o_id, o_d_id, o_w_id -> c_balance*o_ol_cnt
+    ConcurrentHashTable<Key, Numeric<12, 4>> orders;
+    std::vector<WorkerLocal<std::vector<decltype(orders)::Entry>>> orderEntries(pool.size());
+    pool.parallelFor(db->order.size(), [&](size_t begin, size_t end, unsigned worker) {
+        auto& entries = orderEntries[worker].value;
+        for (size_t i = begin; i < end; i++) {
+            Key customerKey, key;
+            Numeric<12, 2> o_ol_cnt;
+            bool visible = false;
+            read(db->order, i, [&](const auto& row) {
+                customerKey = std::make_tuple(row.o_c_id, row.o_d_id, row.o_w_id);
+                key = std::make_tuple(row.o_id, row.o_d_id, row.o_w_id);
+                o_ol_cnt = row.o_ol_cnt.template castS<12>().castP2();
+                visible = true;
+            });
+            if (!visible) {
+                continue;
+            }
+            auto balance = customers.find(customerKey); // o_w_id = c_w_id and o_d_id = c_d_id and o_c_id = c_id
+            if (balance) {
+                entries.push_back(orders.makeEntry(key, *balance * o_ol_cnt));
+            }
+        }
+    });
+    size_t orderCount = 0;
+    for (auto& entries : orderEntries) {
+        orderCount += entries.value.size();
+    }
+    orders.setSize(orderCount);
+    pool.parallelFor(orderEntries.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; i++) {
+            for (auto& entry : orderEntries[i].value) {
+                orders.insert(&entry);
+            }
+        }
+    }, 1);
+
+    // Every worker sums up its own morsels
+    std::vector<WorkerLocal<Numeric<12, 4>>> sums(pool.size());
+    pool.parallelFor(db->orderline.size(), [&](size_t begin, size_t end, unsigned worker) {
+        Numeric<12, 4> sum = 0;
+        for (size_t i = begin; i < end; i++) {
+            Key key;
+            Numeric<12, 4> amount;
+            bool visible = false;
+            read(db->orderline, i, [&](const auto& row) {
+                key = std::make_tuple(row.ol_o_id, row.ol_d_id, row.ol_w_id);
+                amount = row.ol_quantity.template castS<12>().castP2() * row.ol_amount.template castS<12>();
+                visible = true;
+            });
+            if (!visible) {
+                continue;
+            }
+            auto order = orders.find(key); //o_w_id = ol_w_id and o_d_id = ol_d_id and o_id = ol_o_id
+            if (order) { //If found, sum it up
+                //sum(ol_quantity*ol_amount-c_balance*o_ol_cnt)
+                sum += amount - *order;
+            }
+        }
+        sums[worker].value += sum;
+    });
+
+    Numeric<12, 4> sum = 0;
+    for (auto& partial : sums) {
+        sum += partial.value;
+    }
+    return sum;
+}
+
+/// statSum on the current state, e.g. in a forked child
+Numeric<12, 4> statSum(Database* db, ThreadPool& pool) {
+    return statSum(db, pool, [](auto& table, size_t i, auto&& f) { f(table.row(i)); }, true);
+}
+
+/// statSum reading the tables as of the given snapshot while the writer keeps going
+Numeric<12, 4> statSum(Database* db, const Snapshot& snapshot, ThreadPool& pool) {
+    return statSum(db, pool, [&](auto& table, size_t i, auto&& f) { table.read(i, snapshot, f); }, false);
+}
+
+using CustomerRow = decltype(Database::customer)::Row;
+using OrderRow = decltype(Database::order)::Row;
+using OrderlineRow = decltype(Database::orderline)::Row;
+
+/// statSum as a materialized view, kept up to date from the changes of the transactions so that reading it is O(1).
+/// Per customer it keeps sum(ol_quantity*ol_amount) and sum(o_ol_cnt) over the orderlines of its orders, the query
+/// result is the sum of amount - c_balance*count over the customers with c_last like 'B%'.
+class StatSumView : TableObserver<CustomerRow>, TableObserver<OrderRow>, TableObserver<OrderlineRow> {
+    // c_id, c_d_id, c_w_id
+    using Key = std::tuple<Integer, Integer, Integer>;
+
+    struct Customer {
+        Numeric<12, 4> amount = 0;
+        int64_t count = 0;
+        Numeric<12, 2> balance = 0;
+        /// The customer exists and c_last like 'B%'
+        bool matches = false;
+
+        Numeric<12, 4> contribution() const {
+            return matches ? amount - balance * Numeric<12, 0>(count).castP2() : Numeric<12, 4>(0);
+        }
+    };
+
+    Database* db;
+    std::unordered_map<Key, Customer> customers;
+    Numeric<12, 4> sum = 0;
+
+    static Key customerKey(const OrderRow& order) { return std::make_tuple(order.o_c_id, order.o_d_id, order.o_w_id); }
+
+    /// Change one customer and the sum accordingly
+    template<typename F>
+    void change(const Key& key, F&& f) {
+        Customer& customer = customers[key];
+        sum = sum - customer.contribution();
+        f(customer);
+        sum += customer.contribution();
+    }
+
+    /// Add (sign 1) or subtract (sign -1) the orderlines of an order
+    void changeOrder(const OrderRow& order, int sign) {
+        Numeric<12, 4> amount = 0;
+        int64_t lines = 0;
+        auto& orderlines = db->orderline;
+        for (auto itr = orderlines.pkTree.lower_bound(std::make_tuple(order.o_w_id, order.o_d_id, order.o_id, INT32_MIN));
+             itr != orderlines.pkTree.end() && std::get<0>(itr->first) == order.o_w_id && std::get<1>(itr->first) == order.o_d_id &&
+             std::get<2>(itr->first) == order.o_id; ++itr) {
+            const auto& line = orderlines.row(itr->second);
+            amount += line.ol_quantity.castS<12>().castP2() * line.ol_amount.castS<12>();
+            lines++;
+        }
+        if (lines == 0) { // newOrder inserts the order before its orderlines
+            return;
+        }
+        change(customerKey(order), [&](Customer& customer) {
+            customer.amount = sign > 0 ? customer.amount + amount : customer.amount - amount;
+            customer.count += sign * lines * order.o_ol_cnt.value;
+        });
+    }
+
+    /// Add (sign 1) or subtract (sign -1) an orderline, it only counts once its order exists
+    void changeOrderline(const OrderlineRow& line, int sign) {
+        const auto order = db->order.pk.find(std::make_tuple(line.ol_w_id, line.ol_d_id, line.ol_o_id));
+        if (order == db->order.pk.end()) {
+            return;
+        }
+        const auto& row = db->order.row(order->second);
+        const auto amount = line.ol_quantity.castS<12>().castP2() * line.ol_amount.castS<12>();
+        change(customerKey(row), [&](Customer& customer) {
+            customer.amount = sign > 0 ? customer.amount + amount : customer.amount - amount;
+            customer.count += sign * row.o_ol_cnt.value;
+        });
+    }
+
+    void inserted(const CustomerRow& row) override {
+        change(std::make_tuple(row.c_id, row.c_d_id, row.c_w_id), [&](Customer& customer) {
+            customer.balance = row.c_balance;
+            customer.matches = row.c_last.value[0] == 'B'; // c_last like 'B%'
+        });
+    }
+
+    void updated(const CustomerRow& before, const CustomerRow& after) override {
+        if (before.key() != after.key()) {
+            removed(before);
+        }
+        inserted(after);
+    }
+
+    void removed(const CustomerRow& row) override {
+        change(std::make_tuple(row.c_id, row.c_d_id, row.c_w_id), [](Customer& customer) { customer.matches = false; });
+    }
+
+    void inserted(const OrderRow& row) override { changeOrder(row, 1); }
+
+    void updated(const OrderRow& before, const OrderRow& after) override {
+        // delivery only sets the carrier
+        if (before.key() == after.key() && before.o_c_id == after.o_c_id && before.o_ol_cnt == after.o_ol_cnt) {
+            return;
+        }
+        changeOrder(before, -1);
+        changeOrder(after, 1);
+    }
+
+    void removed(const OrderRow& row) override { changeOrder(row, -1); }
+
+    void inserted(const OrderlineRow& row) override { changeOrderline(row, 1); }
+
+    void updated(const OrderlineRow& before, const OrderlineRow& after) override {
+        // delivery only sets the delivery date
+        if (before.key() == after.key() && before.ol_quantity == after.ol_quantity && before.ol_amount == after.ol_amount) {
+            return;
+        }
+        changeOrderline(before, -1);
+        changeOrderline(after, 1);
+    }
+
+    void removed(const OrderlineRow& row) override { changeOrderline(row, -1); }
+
+public:
+    /// Compute the view from the current tables and register with them
+    explicit StatSumView(Database* db) : db(db) {
+        customers.reserve(db->customer.size());
+        for (size_t i = 0; i < db->customer.size(); i++) {
+            inserted(db->customer.row(i));
+        }
+        for (size_t i = 0; i < db->orderline.size(); i++) {
+            changeOrderline(db->orderline.row(i), 1);
+        }
+        db->customer.observers.add(this);
+        db->order.observers.add(this);
+        db->orderline.observers.add(this);
+    }
+
+    StatSumView(const StatSumView&) = delete;
+
+    ~StatSumView() {
+        db->customer.observers.remove(this);
+        db->order.observers.remove(this);
+        db->orderline.observers.remove(this);
+    }
+
+    Numeric<12, 4> result() const { return sum; }
+};
+
+/// Query statistics, shared with the forked children
+struct QueryStats {
+    atomic<uint64_t> queries{0};
+    atomic<uint64_t> queryMicros{0};
+    atomic<uint64_t> snapshotMicros{0};
+};
+
+static void runQuery(Database* db, int iterations, ThreadPool& pool) {
+    int totalSeconds = 0, parallelSeconds = 0;
+    Numeric<12, 4> result, parallelResult;
     for (int i = 0; i < iterations; i++) {
         auto begin = high_resolution_clock::now();
         result = statSum(db);
         auto end = high_resolution_clock::now();
         totalSeconds += duration_cast<milliseconds>(end - begin).count();
+
+        begin = high_resolution_clock::now();
+        parallelResult = statSum(db, pool);
+        end = high_resolution_clock::now();
+        parallelSeconds += duration_cast<milliseconds>(end - begin).count();
     }
     cout << "Query result (" << iterations << "x): " << result << " took on average " << totalSeconds / iterations << "ms" << endl;
+    cout << "Parallel query result (" << pool.size() << " workers): " << parallelResult << " took on average " << parallelSeconds / iterations << "ms" << endl;
+}
+
+/// Run statSum on fresh snapshots until the writer is done
+static void runSnapshotQueries(Database* db, QueryStats* stats, const atomic<bool>* done, unsigned workers) {
+    ThreadPool pool(workers);
+    while (!*done) {
+        auto begin = high_resolution_clock::now();
+        Snapshot snapshot = db->mvcc.snapshot();
+        auto start = high_resolution_clock::now();
+        statSum(db, snapshot, pool);
+        db->mvcc.release(snapshot);
+        auto end = high_resolution_clock::now();
+
+        stats->queries++;
+        stats->snapshotMicros += duration_cast<microseconds>(start - begin).count();
+        stats->queryMicros += duration_cast<microseconds>(end - start).count();
+    }
+}
+
+/// Compare the string filter kernels with row by row evaluation on c_last
+static void benchmarkFilters(Database* db) {
+    auto& cust = db->customer;
+    const size_t rows = cust.size();
+    const int repetitions = 20;
+    static uint32_t sel[ThreadPool::morselSize];
+
+    // Runs f(first row, rows in chunk) for every chunk of the table and reports the time per row
+    auto measure = [&](const char* name, auto&& f) {
+        size_t matches = 0;
+        auto begin = high_resolution_clock::now();
+        for (int r = 0; r < repetitions; r++) {
+            for (size_t i = 0; i < rows; i += ThreadPool::morselSize) {
+                matches += f(cust.row(i), min(rows - i, ThreadPool::morselSize));
+            }
+        }
+        auto end = high_resolution_clock::now();
+        cout << "\t" << setw(28) << left << name << setw(8) << right << matches / repetitions << " rows, "
+             << duration_cast<nanoseconds>(end - begin).count() / double(rows * repetitions) << "ns per row" << endl;
+    };
+
+    using Row = std::remove_reference<decltype(cust.row(0))>::type;
+    const auto rowwise = [](auto&& predicate) {
+        return [predicate](const Row& first, size_t n) {
+            unsigned count = 0;
+            for (size_t i = 0; i < n; i++) {
+                count += predicate((&first)[i].c_last);
+            }
+            return count;
+        };
+    };
+
+    cout << "Filter kernels on customer.c_last (" << rows << " rows)" << endl;
+    measure("like 'B%' row by row", rowwise([](const auto& c) { return c.value[0] == 'B'; }));
+    measure("like 'B%' kernel", [&](const Row& first, size_t n) { return selectPrefix(&first.c_last, sizeof(Row), n, "B", 1, sel); });
+    measure("like 'ANTI%' row by row", rowwise([](const auto& c) { return c.len >= 4 && memcmp(c.value, "ANTI", 4) == 0; }));
+    measure("like 'ANTI%' kernel", [&](const Row& first, size_t n) { return selectPrefix(&first.c_last, sizeof(Row), n, "ANTI", 4, sel); });
+    measure("= 'BARBARBAR' row by row", rowwise([](const auto& c) { return c == "BARBARBAR"; }));
+    measure("= 'BARBARBAR' kernel", [&](const Row& first, size_t n) { return selectEqual(&first.c_last, sizeof(Row), n, "BARBARBAR", 9, sel); });
+    measure("like '%ESE%' row by row", rowwise([](const auto& c) { return likeMatch(c.value, c.len, "%ESE%", 5); }));
+    measure("like '%ESE%' kernel", [&](const Row& first, size_t n) { return selectContains(&first.c_last, sizeof(Row), n, "ESE", 3, sel); });
 }
 
 atomic<bool> childRunning;
@@ -240,6 +593,74 @@ static void SIGCHLD_handler(int /*sig*/) {
     childRunning = false;
 }
 
+/// Random row and index accesses and a full scan, on large tables these mostly measure TLB misses
+static void benchmarkMemory(Database* db) {
+    const size_t accesses = 4 * 1024 * 1024;
+    mt19937 random(42);
+    auto measure = [&](const char* name, size_t count, auto&& f) {
+        auto begin = high_resolution_clock::now();
+        int64_t checksum = f();
+        auto end = high_resolution_clock::now();
+        cout << "\t" << setw(28) << left << name << duration_cast<nanoseconds>(end - begin).count() / double(count) << "ns per row (checksum " << checksum << ")" << endl;
+    };
+
+    vector<uint32_t> stockRows(accesses), orderlineRows(accesses);
+    for (size_t i = 0; i < accesses; i++) {
+        stockRows[i] = random() % db->stock.size();
+        orderlineRows[i] = random() % db->orderline.size();
+    }
+    vector<tuple<Integer, Integer>> stockKeys;
+    for (size_t i = 0; i < accesses / 4; i++) {
+        stockKeys.push_back(db->stock.row(stockRows[i]).key());
+    }
+
+    cout << "Memory access on " << db->stock.size() << " stock and " << db->orderline.size() << " orderline rows" << endl;
+    measure("random stock rows", accesses, [&]() {
+        int64_t sum = 0;
+        for (auto i : stockRows) {
+            sum += db->stock.row(i).s_quantity.value;
+        }
+        return sum;
+    });
+    measure("random orderline rows", accesses, [&]() {
+        int64_t sum = 0;
+        for (auto i : orderlineRows) {
+            sum += db->orderline.row(i).ol_amount.value;
+        }
+        return sum;
+    });
+    measure("stock primary key lookups", stockKeys.size(), [&]() {
+        int64_t sum = 0;
+        for (auto& key : stockKeys) {
+            sum += db->stock.pk.find(key)->second;
+        }
+        return sum;
+    });
+    const int passes = 5;
+    measure("orderline scan", passes * db->orderline.size(), [&]() {
+        int64_t sum = 0;
+        for (int pass = 0; pass < passes; pass++) {
+            for (size_t i = 0; i < db->orderline.size(); i++) {
+                sum += db->orderline.row(i).ol_amount.value;
+            }
+        }
+        return sum;
+    });
+}
+
+/// Size of the anonymous memory of this process that is backed by transparent huge pages
+static string anonHugePages() {
+    ifstream smaps("/proc/self/smaps_rollup");
+    string line;
+    while (getline(smaps, line)) {
+        if (line.compare(0, 14, "AnonHugePages:") == 0) {
+            return line.substr(line.find_first_not_of(' ', 14));
+        }
+    }
+    return "unknown";
+}
+
+/// Usage: runDatabase [fork|mvcc|filter|memory] [query threads] [iterations] [workers per query] [--pages=default|thp|hugetlb] [--view]
 int main(int argc, char** argv) {
     //Init our fork logic
     struct sigaction sa;
@@ -248,8 +669,31 @@ int main(int argc, char** argv) {
     sa.sa_handler = SIGCHLD_handler;
     sigaction(SIGCHLD, &sa, NULL);
 
+    //Options start with "--", everything else is positional
+    StorageOptions options;
+    bool withView = false;
+    vector<string> args;
+    try {
+        for (int i = 1; i < argc; i++) {
+            const string arg = argv[i];
+            if (arg.compare(0, 8, "--pages=") == 0) {
+                options.pages = StorageOptions::parsePages(arg.substr(8));
+            } else if (arg == "--view") {
+                withView = true;
+            } else {
+                args.push_back(arg);
+            }
+        }
+    } catch (char const* str) {
+        std::cerr << str << std::endl;
+        return 1;
+    }
+    const string mode = args.size() > 0 ? args[0] : "fork";
+    const bool useMvcc = mode == "mvcc";
+    const int queryThreads = args.size() > 1 ? stoi(args[1]) : 1;
+
     //Start up the database
-    Database* db = new Database();
+    Database* db = new Database(options);
 
     //Fixed number of iterations
 #ifdef ENABLE_DEBUG_MACRO
@@ -257,6 +701,16 @@ int main(int argc, char** argv) {
 #else
     long iterations = 1000000;
 #endif
+    if (args.size() > 2) {
+        iterations = stol(args[2]);
+    }
+    //By default the queries share all cores
+    const unsigned cores = max(thread::hardware_concurrency(), 1u);
+    const unsigned workers = args.size() > 3 ? stoi(args[3]) : max(cores / (useMvcc ? max(queryThreads, 1) : 1), 1u);
+
+    //The forked children report back through shared memory
+    void* shared = mmap(nullptr, sizeof(QueryStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    QueryStats* stats = new(shared) QueryStats();
 
     cout << "TPC-C Testrun" << endl;
     cout << "--------------------------" << endl;
@@ -267,10 +721,48 @@ int main(int argc, char** argv) {
         auto begin = high_resolution_clock::now();
         db->import("../tbl/");
         cout << "done loading in " << duration_cast<seconds>(high_resolution_clock::now() - begin).count() << " seconds." << endl;
+        const char* policies[] = {"default", "transparent huge pages", "huge page pool"};
+        cout << "Pages: " << policies[static_cast<int>(PageAllocator::policy())]
+             << (PageAllocator::hugeTLBFailed() ? " (pool empty, fell back to transparent huge pages)" : "")
+             << ", AnonHugePages: " << anonHugePages() << endl;
+        if (mode == "filter" || mode == "memory") {
+            if (mode == "filter") {
+                benchmarkFilters(db);
+            } else {
+                benchmarkMemory(db);
+            }
+            delete db;
+            return 0;
+        }
+
+
+        cout << endl << "Starting simulation with " << iterations << " iterations ";
+        if (useMvcc) {
+            cout << "(mvcc snapshots, " << queryThreads << " query threads with " << workers << " workers) ..." << endl << endl;
+        } else {
+            cout << "(fork snapshots, " << workers << " workers) ..." << endl << endl;
+        }
+        {
+            ThreadPool pool(workers);
+            runQuery(db, 10, pool);
+        }
 
+        //The transactions keep the materialized statSum up to date
+        unique_ptr<StatSumView> view;
+        if (withView) {
+            begin = high_resolution_clock::now();
+            view.reset(new StatSumView(db));
+            cout << "Materialized view: " << view->result() << " computed in "
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - begin).count() << "ms" << endl;
+        }
 
-        cout << endl << "Starting simulation with " << iterations << " iterations ..." << endl << endl;
-        runQuery(db, 10);
+        atomic<bool> done{false};
+        vector<thread> readers;
+        if (useMvcc) {
+            for (int i = 0; i < queryThreads; i++) {
+                readers.emplace_back(runSnapshotQueries, db, stats, &done, workers);
+            }
+        }
 
         begin = high_resolution_clock::now();
         int deliveries = 0, newOrders = 0;
@@ -280,12 +772,15 @@ int main(int argc, char** argv) {
             pid_t pid = ~0;
 
             //Start the child running the query if it finished
-            if (!childRunning) {
+            if (!useMvcc && !childRunning) {
                 childRunning = true;
                 pid = fork();
             }
 
             if (pid) { // parent
+                if (useMvcc) {
+                    db->mvcc.begin();
+                }
                 if (urand(1, 100) <= 10) {
                     deliveryRandom(db);
                     deliveries++;
@@ -293,31 +788,70 @@ int main(int argc, char** argv) {
                     newOrderRandom(db);
                     newOrders++;
                 }
-            } else { // forked child
+                if (useMvcc) {
+                    db->mvcc.commit();
+                    if (i % 1000 == 0) {
+                        db->collectGarbage();
+                    }
+                }
+            } else { // forked child, only the forking thread survives so it needs its own workers
+                auto start = high_resolution_clock::now();
+                ThreadPool pool(workers);
+                statSum(db, pool);
                 auto end = high_resolution_clock::now();
-                cout << "Child fork took " << duration_cast<milliseconds>(end - begin).count() << "ms" << endl;
-                runQuery(db, 1);
-                return 0; // child is finished
+                stats->queries++;
+                stats->snapshotMicros += duration_cast<microseconds>(start - begin).count();
+                stats->queryMicros += duration_cast<microseconds>(end - start).count();
+                _exit(0); // child is finished
             }
-            if (i % (iterations / 10) == 0) {
+            if (iterations >= 10 && i % (iterations / 10) == 0) {
                 cout << ((double) i / (double) iterations * 100.0) << "% done" << endl;
             }
         }
         auto end = high_resolution_clock::now();
-        // wait for child finishing
+        // wait for the queries finishing
+        done = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
         while(childRunning);
 
-        cout << "done. " << "Took: " << duration_cast<seconds>(end - begin).count() << " seconds." << endl;
-        cout << "Transactions per second: " << iterations / duration_cast<seconds>(end - begin).count() << endl;
+        const auto millis = max<long>(duration_cast<milliseconds>(end - begin).count(), 1);
+        const uint64_t queries = max<uint64_t>(stats->queries, 1);
+        cout << "done. " << "Took: " << millis / 1000.0 << " seconds." << endl;
+        cout << "Transactions per second: " << iterations * 1000 / millis << endl;
+        cout << "Queries: " << stats->queries << " took on average " << stats->queryMicros / queries / 1000.0 << "ms, "
+             << (useMvcc ? "taking the snapshot" : "the fork") << " took on average " << stats->snapshotMicros / queries / 1000.0 << "ms" << endl;
         cout << "New Orders: " << newOrders << " / Deliveries: " << deliveries << " / Ratio " << ((double) deliveries / (double) newOrders) * 100 << "%" << endl;
+        if (useMvcc) {
+            db->collectGarbage();
+        }
         cout << "Counts: " << db->order.size() << " orders | " << db->neworder.size() << " newOrders | " << db->orderline.size() << " orderlines " << endl;
 
+        if (useMvcc) {
+            Snapshot snapshot = db->mvcc.snapshot();
+            auto expected = statSum(db);
+            ThreadPool pool(workers);
+            auto result = statSum(db, snapshot, pool);
+            db->mvcc.release(snapshot);
+            cout << "Snapshot query result: " << result << (result == expected ? " (matches)" : " (MISMATCH)") << endl;
+        }
+        if (view) {
+            auto expected = statSum(db);
+            begin = high_resolution_clock::now();
+            auto result = view->result();
+            auto end = high_resolution_clock::now();
+            cout << "Materialized view result: " << result << (result == expected ? " (matches)" : " (MISMATCH)") << " read in "
+                 << duration_cast<nanoseconds>(end - begin).count() << "ns" << endl;
+        }
+
     } catch (std::exception const& exc) {
         std::cerr << "Exception caught " << exc.what() << "\n";
     } catch (char const* str) {
         std::cerr << str;
     }
 
+    munmap(shared, sizeof(QueryStats));
     delete db;
     return 0;
 }
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <ostream>
 #include <cassert>
+#include <algorithm>
 
 //---------------------------------------------------------------------------
 // HyPer
@@ -176,7 +177,7 @@ template<unsigned maxLen>
 bool Varchar<maxLen>::operator<(const Varchar &other) const
 // Comparison
 {
-    int c = memcmp(value, other.value, min(len, other.len));
+    int c = memcmp(value, other.value, std::min<unsigned>(len, other.len));
     if (c < 0) { return true; }
     if (c > 0) { return false; }
     return len < other.len;
@@ -275,7 +276,7 @@ template<unsigned maxLen>
 bool Char<maxLen>::operator<(const Char &other) const
 // Comparison
 {
-    int c = memcmp(value, other.value, min(len, other.len));
+    int c = memcmp(value, other.value, std::min<unsigned>(len, other.len));
     if (c < 0) { return true; }
     if (c > 0) { return false; }
     return len < other.len;
@@ -286,7 +287,7 @@ template<unsigned maxLen>
 bool Char<maxLen>::operator>(const Char &other) const
 // Comparison
 {
-    int c = memcmp(value, other.value, min(len, other.len));
+    int c = memcmp(value, other.value, std::min<unsigned>(len, other.len));
     if (c < 0) { return false; }
     if (c > 0) { return true; }
     return len > other.len;
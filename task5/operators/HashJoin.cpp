@@ -37,7 +37,7 @@ string HashJoin::produce() {
     stringstream out;
     stringstream comment;
     comment << "// Fields: ";
-    out << "unordered_multimap<tuple<";
+    out << "HashJoinTable<tuple<";
     for (auto& c : conditions) {
         out << Schema::type(*get<0>(c)->attr, 1);
         comment << get<0>(c)->attr->name << ", ";
@@ -57,6 +57,7 @@ string HashJoin::produce() {
     }
     out << ">> " << mapName << "; " << endl << comment.str() << endl;
     out << left.produce();
+    out << mapName << ".finalize();" << endl;
     out << right.produce();
 
     return out.str();
@@ -65,7 +66,7 @@ string HashJoin::produce() {
 string HashJoin::consume(Operator& op) {
     stringstream out;
     if (&op == &left) {
-        out << mapName << ".insert({{";
+        out << mapName << ".insert({";
         for (auto& c : conditions) {
             out << get<0>(c)->attr->name;
             if (c != *(conditions.end() - 1)) {
@@ -80,22 +81,20 @@ string HashJoin::consume(Operator& op) {
                 out << ",";
             }
         }
-        out << "}});" << endl;
+        out << "});" << endl;
     } else {
-        string range = mapName + "Range";
-        out << "auto " << range << " =" << mapName << ".equal_range({";
+        out << mapName << ".probe({";
         for (auto& c : conditions) {
             out << get<1>(c)->attr->name;
             if (c != *(conditions.end() - 1)) {
                 out << ",";
             }
         }
-        out << "}); " << endl;
-        out << "for_each(" << range << ".first, " << range << ".second, [&](auto& mapElement){ " << endl;
+        out << "}, [&](const auto& mapElement) { " << endl;
         auto intersect = intersectDeps();
         int i = 0;
         for (auto& c : intersect) {
-            out << Schema::type(*c->attr, 1) << " " << c->attr->name << " = get<" << i << ">(get<1>(mapElement));" << endl;
+            out << Schema::type(*c->attr, 1) << " " << c->attr->name << " = get<" << i << ">(mapElement);" << endl;
             i++;
         }
         out << consumer->consume(*this);
@@ -20,6 +20,26 @@ void Operator::setConsumer(Operator* op) {
     this->consumer = op;
 }
 
+string Operator::literal(const string& value) {
+    string out = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"':
+            case '\\':
+            case '?': //No trigraphs
+                out += '\\';
+                out += c;
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+        }
+    }
+    return out + "\"";
+}
+
 string Operator::randomEntityName(std::string::size_type length) {
     static auto& chrs = "0123456789"
             "abcdefghijklmnopqrstuvwxyz"
@@ -33,6 +33,9 @@ public:
 
     string randomEntityName(std::string::size_type len = 5);
 
+    /// A string as a C++ string literal in the generated code, with quotes and backslashes escaped
+    static string literal(const string& value);
+
 protected:
     Operator* consumer;
     set<IU*> produced{};
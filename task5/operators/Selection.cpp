@@ -3,7 +3,7 @@
 #include "Selection.h"
 #include "../parser/IU.h"
 
-Selection::Selection(shared_ptr<Operator> in, vector<tuple<IU*, string>> cond) : input(in), conditions(cond) {
+Selection::Selection(shared_ptr<Operator> in, vector<tuple<IU*, string, string>> cond) : input(in), conditions(cond) {
     input->setConsumer(this);
     for (auto& c : conditions) {
         this->required.insert(get<0>(c));
@@ -13,16 +13,33 @@ Selection::Selection(shared_ptr<Operator> in, vector<tuple<IU*, string>> cond) :
 
 string Selection::produce() {
     this->required.insert(consumer->getRequired().begin(), consumer->getRequired().end());
-    return input->produce();
+
+    //The other comparisons need the constant in the type of the column, it is cast once before the scan
+    stringstream out;
+    constants.clear();
+    for (auto& c : conditions) {
+        if (get<1>(c) == "=") {
+            constants.emplace_back();
+            continue;
+        }
+        const string name = "constant" + randomEntityName();
+        const string text = unquote(get<2>(c));
+        out << "const auto " << name << " = " << Schema::type(*get<0>(c)->attr, true) << "::castString("
+            << literal(text) << ", " << text.size() << ");" << endl;
+        constants.push_back(name);
+    }
+    out << input->produce();
+    return out.str();
 }
 
 string Selection::consume(Operator& op) {
     stringstream out;
 
     out << "if(";
-    for (auto& c : conditions) {
-        out << (get<0>(c))->attr->name << " == " << get<1>(c);
-        if(c != *(conditions.end()-1)) {
+    for (size_t i = 0; i < conditions.size(); i++) {
+        auto& c = conditions[i];
+        out << compare(get<0>(c), get<1>(c), get<2>(c), constants[i]);
+        if (i + 1 < conditions.size()) {
             out << " && ";
         }
     }
@@ -32,4 +49,29 @@ string Selection::consume(Operator& op) {
     return out.str();
 }
 
+string Selection::unquote(const string& value) {
+    if (value.size() >= 2 && value.front() == '"') {
+        return value.substr(1, value.size() - 2);
+    }
+    return value;
+}
+
+string Selection::compare(IU* iu, const string& comparison, const string& value, const string& constant) {
+    const string& name = iu->attr->name;
+    if (comparison == "=") {
+        const string text = unquote(value);
+        return name + " == " + (text.size() == value.size() ? value : literal(text));
+    }
 
+    //All types have == and <
+    if (comparison == "<>") {
+        return "!(" + name + " == " + constant + ")";
+    } else if (comparison == "<") {
+        return name + " < " + constant;
+    } else if (comparison == "<=") {
+        return "!(" + constant + " < " + name + ")";
+    } else if (comparison == ">") {
+        return constant + " < " + name;
+    }
+    return "!(" + name + " < " + constant + ")";
+}
@@ -7,10 +7,19 @@
 
 class Selection:public  Operator  {
     shared_ptr<Operator> input;
-    vector<tuple<IU*, string>> conditions;
+    /// Column, comparison and constant
+    vector<tuple<IU*, string, string>> conditions;
+    /// Locals holding the constants of the conditions cast to the type of their column, empty for an equality
+    vector<string> constants;
+
+    /// The text of a constant without the quotes of a string
+    static string unquote(const string& value);
+
+    /// The code of a condition, constant is the local of its cast constant
+    static string compare(IU* iu, const string& comparison, const string& value, const string& constant);
 
 public:
-    Selection(shared_ptr<Operator> input, vector<tuple<IU*, string>> condition);
+    Selection(shared_ptr<Operator> input, vector<tuple<IU*, string, string>> condition);
 
     string produce() override;
     string consume(Operator&) override;
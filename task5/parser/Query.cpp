@@ -23,7 +23,7 @@ string Query::toString() const {
     }
     out << endl << "WHERE: \n\t SEL: ";
     for (auto e : this->selection) {
-        out << get<0>(e) << "=" << get<1>(e) << " ";
+        out << get<0>(e) << get<1>(e) << get<2>(e) << " ";
     }
     out << "\n\t JOI: ";
     for (auto e : this->joinConditions) {
@@ -34,8 +34,8 @@ string Query::toString() const {
 }
 
 
-vector<tuple<IU*, string>> Query::getSelections(Operator* op) {
-    vector<tuple<IU*, string>> conditions;
+vector<tuple<IU*, string, string>> Query::getSelections(Operator* op) {
+    vector<tuple<IU*, string, string>> conditions;
     auto operatorIUs = op->getProduced();
 
     //Iterate through all selections
@@ -43,7 +43,7 @@ vector<tuple<IU*, string>> Query::getSelections(Operator* op) {
         //Check all produced operators
         for (auto iu : operatorIUs) {
             if (iu->attr->name == get<0>(s)) { // if they match, add the iu and selection value to the list
-                conditions.emplace_back(make_tuple(iu, get<1>(s)));
+                conditions.emplace_back(make_tuple(iu, get<1>(s), get<2>(s)));
             }
         }
     }
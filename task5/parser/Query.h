@@ -20,17 +20,19 @@
 
 using namespace std;
 using conditionType = tuple<string, string>;
+/// Column, comparison (=, <>, <, <=, > or >=) and constant of a selection
+using selectionType = tuple<string, string, string>;
 
 class Query {
     friend class QueryParser;
 
     vector<string> projection;
     vector<string> relation;
-    vector<conditionType> selection;
+    vector<selectionType> selection;
     vector<conditionType> joinConditions;
     Schema* schema;
 
-    vector<tuple<IU*, string>> getSelections(Operator*);
+    vector<tuple<IU*, string, string>> getSelections(Operator*);
 
     vector<tuple<IU*, IU*>> getJoinConditions(Operator*, Operator*);
 
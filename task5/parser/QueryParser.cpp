@@ -6,6 +6,7 @@ namespace keyword {
     const string From = "from";
     const string Where = "where";
     const string And = "and";
+    const string Between = "between";
 }
 
 namespace literal {
@@ -57,6 +58,17 @@ static bool isValue(const string& str) {
 }
 
 static string leftPredicate = "";
+static string comparison = "";
+
+static bool isComparison(const string& str) {
+    return str == "=" || str == "<>" || str == "<" || str == "<=" || str == ">" || str == ">=";
+}
+
+static string constant(const string& token) {
+    string value = token;
+    replace(value.begin(), value.end(), '\'', '"');
+    return value;
+}
 
 void QueryParser::nextToken(const string& token, Query& query) {
     if (getenv("DEBUG")) {
@@ -138,19 +150,38 @@ void QueryParser::nextToken(const string& token, Query& query) {
             }
             break;
         case State::WhereEquals:
-            if (tok.size() == 1 && tok[0] == literal::Equals) {
+            if (isComparison(tok)) {
+                comparison = tok;
+                state = State::WhereRight;
+            } else if (tok == keyword::Between) {
+                state = State::WhereBetweenLower;
+            } else {
+                throw ParserError(0, "Expected comparison or 'BETWEEN', found '" + token + "'");
+            }
+            break;
+        case State::WhereBetweenLower:
+            if (isValue(tok)) {
+                query.selection.push_back(make_tuple(leftPredicate, ">=", constant(token)));
+                state = State::WhereBetweenAnd;
+            } else {
+                throw ParserError(0, "Expected constant after 'BETWEEN', found '" + token + "'");
+            }
+            break;
+        case State::WhereBetweenAnd:
+            if (tok == keyword::And) {
+                comparison = "<=";
                 state = State::WhereRight;
             } else {
-                throw ParserError(0, "Expected '=', found '" + token + "'");
+                throw ParserError(0, "Expected 'AND' of 'BETWEEN', found '" + token + "'");
             }
             break;
         case State::WhereRight:
             if (isValue(tok)) {
-                tok = token;
-                replace(tok.begin(), tok.end(), '\'', '"');
-                query.selection.push_back(make_tuple(leftPredicate, tok));
+                query.selection.push_back(make_tuple(leftPredicate, comparison, constant(token)));
                 leftPredicate = "";
                 state = State::WhereAnd;
+            } else if (isIdentifier(tok) && comparison != "=") {
+                throw ParserError(0, "Columns can only be compared with '=', found '" + comparison + "'");
             } else if (isIdentifier(tok)) {
                 query.joinConditions.push_back(make_tuple(leftPredicate, tok));
                 leftPredicate = "";
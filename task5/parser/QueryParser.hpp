@@ -26,6 +26,7 @@ class QueryParser {
         SelectItem, SelectEnd,
         FromItem, FromEnd,
         WhereLeft, WhereEquals, WhereRight, WhereAnd,
+        WhereBetweenLower, WhereBetweenAnd,
         Semicolon
     };
 
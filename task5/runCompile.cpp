@@ -108,6 +108,7 @@ string parseAndWriteQuery(const string& query, Schema* s) {
     myfile << "#include <tuple>" << endl
            << "#include \"db.cpp\"" << endl
            << "#include \"../Types.hpp\"" << endl
+           << "#include \"../hash_join_table.h\"" << endl
            << "#include <algorithm>" << endl;
     myfile << "using namespace std;" << endl;
     myfile << "/* " << qu.get()->toString() << " */ " << endl;